@@ -1,216 +1,548 @@
-#include <Contact_class.h>
-#include <regex>
-#include <ctime>
-
-namespace
-{
-    std::string trim(const std::string& str)
-    {
-        const char* ws = " \t\n\r\f\v";
-
-        std::size_t first = str.find_first_not_of(ws);
-        if (first == std::string::npos)
-            return {};
-
-        std::size_t last = str.find_last_not_of(ws);
-        return str.substr(first, last - first + 1);
-    }
-
-    bool isLeap(int year)
-    {
-        return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-    }
-
-    int daysInMonth(int month, int year)
-    {
-        switch (month)
-        {
-        case 1: case 3: case 5: case 7:
-        case 8: case 10: case 12:
-            return 31;
-        case 4: case 6: case 9: case 11:
-            return 30;
-        case 2:
-            return isLeap(year) ? 29 : 28;
-        default:
-            return 0;
-        }
-    }
-
-    Contact::Date currentDate()
-    {
-        std::time_t t = std::time(nullptr);
-        std::tm* lt = std::localtime(&t);
-
-        Contact::Date d{};
-        d.day   = lt->tm_mday;
-        d.month = lt->tm_mon + 1;
-        d.year  = lt->tm_year + 1900;
-        return d;
-    }
-
-    bool isValidPhoneNumber(const std::string& raw_number)
-    {
-        std::string s = trim(raw_number);
-        if (s.empty())
-            return false;
-
-        static const std::regex re(
-            R"(^(?:\+7|8)(?:\d{10}|\(\d{3}\)\d{7}|\(\d{3}\)\d{3}-\d{2}-\d{2})$)"
-            );
-
-        return std::regex_match(s, re);
-    }
-
-}
-
-bool Contact::setName             (const std::string&        raw_name)
-    {
-        std::string name = trim(raw_name);
-
-        if (name.empty())
-            return false;
-
-        if (!isValidPersonalName(name))
-            return false;
-
-        name_ = name;
-            return true;
-    }
-bool Contact::setSurname          (const std::string&        raw_surname)
-    {
-        std::string surname = trim(raw_surname);
-
-        if (surname.empty())
-            return false;
-
-        if (!isValidPersonalName(surname))
-            return false;
-
-        surname_ = surname;
-            return true;
-    }
-bool Contact::setPatronymic       (const std::string&        raw_patronymic)
-    {
-        std::string patronymic = trim(raw_patronymic);
-
-        if (patronymic.empty())
-            return false;
-
-        if (!isValidPersonalName(patronymic))
-            return false;
-
-        patronymic_ = patronymic;
-            return true;
-    }
-bool Contact::setEmail            (const std::string&        raw_email)
-    {
-    std::string all = trim(raw_email);
-
-    std::size_t at_pos = all.find('@');
-    if (at_pos == std::string::npos) {
-        return false;
-    }
-
-    std::string user_part   = all.substr(0, at_pos);
-    std::string domain_part = all.substr(at_pos + 1);
-
-    user_part   = trim(user_part);
-    domain_part = trim(domain_part);
-
-    if (user_part.empty() || domain_part.empty()) {
-        return false;
-    }
-
-    std::string normalized = user_part + "@" + domain_part;
-
-    if (!isValidEmail(normalized)) {
-        return false;
-    }
-
-    email_ = normalized;
-    return true;
-    }
-bool Contact::setDate             (const Date&               birth_date)
-    {
-    if (!isValidDate(birth_date))
-            return false;
-
-    birth_date_ = birth_date;
-        return true;
-    }
-bool Contact::setPhones           (const std::vector<Phone>& phones)
-    {
-    if (!isValidPhones(phones)) {
-        return false;
-    }
-
-    phones_ = phones;
-    return true;
-    }
-
-
-bool Contact::isValidPersonalName (const std::string&        personal_name)
-{
-    static const std::regex re(R"(^[[:alpha:]](?:[[:alnum:] -]*[[:alnum:]])?$)");
-    return std::regex_match(personal_name, re);
-}
-bool Contact::isValidEmail        (const std::string&        email)
-{
-    static const std::regex re(
-        R"(^[A-Za-z0-9]+(\.[A-Za-z0-9]+)*@[A-Za-z0-9]+(\.[A-Za-z0-9]+)+$)"
-        );
-    return std::regex_match(email, re);
-}
-bool Contact::isValidDate         (const Date&               birth_date)
-{
-    if (birth_date.month < 1 || birth_date.month > 12)
-        return false;
-
-    int maxDay = daysInMonth(birth_date.month, birth_date.year);
-    if (maxDay == 0)
-        return false;
-
-    if (birth_date.day < 1 || birth_date.day > maxDay)
-        return false;
-
-    Date today = currentDate();
-
-    if (birth_date.year > today.year)
-        return false;
-
-    if (birth_date.year == today.year &&
-        birth_date.month > today.month)
-        return false;
-
-    if (birth_date.year == today.year &&
-        birth_date.month == today.month &&
-        birth_date.day >= today.day)
-        return false;
-
-    return true;
-}
-bool Contact::setAddress          (const std::string&        raw_address)
-{
-    std::string address = trim(raw_address);
-    if (address.empty())
-        return false;
-    address_ = address;
-    return true;
-}
-bool Contact::isValidPhones       (const std::vector<Phone>& phones)
-{
-    if (phones.empty())
-        return false;
-
-    for (const auto& p : phones) {
-        if (!isValidPhoneNumber(p.number)) {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-Contact::Contact(const std::string& name, const std::string& surname, const std::string& email, const std::vector<Phone>& phones)
-    : name_(name),surname_(surname),patronymic_(),email_(email),address_(),birth_date_{},phones_(phones) {}
+#include <Contact_class.h>
+#include "contact_profile.h"
+#include "field_scan.h"
+#include <algorithm>
+#include <ctime>
+#include <string_view>
+
+namespace
+{
+    std::string_view trimView(std::string_view str)
+    {
+        const char* ws = " \t\n\r\f\v";
+
+        std::size_t first = str.find_first_not_of(ws);
+        if (first == std::string_view::npos)
+            return {};
+
+        std::size_t last = str.find_last_not_of(ws);
+        return str.substr(first, last - first + 1);
+    }
+
+    bool isLeap(int year)
+    {
+        return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+    }
+
+    int daysInMonth(int month, int year)
+    {
+        switch (month)
+        {
+        case 1: case 3: case 5: case 7:
+        case 8: case 10: case 12:
+            return 31;
+        case 4: case 6: case 9: case 11:
+            return 30;
+        case 2:
+            return isLeap(year) ? 29 : 28;
+        default:
+            return 0;
+        }
+    }
+
+    // The validators below are hand-written matchers. They accept exactly what the
+    // former std::regex patterns (quoted above each one) accepted in the "C" locale.
+    bool isAsciiAlpha(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+    bool isAsciiDigit(char c) { return c >= '0' && c <= '9'; }
+    bool isAsciiAlnum(char c) { return isAsciiAlpha(c) || isAsciiDigit(c); }
+
+    // Appends the decimal digits of s to acc; false if s holds anything else.
+    bool takeDigits(std::string_view s, std::uint64_t& acc)
+    {
+        for (char c : s)
+        {
+            if (!isAsciiDigit(c))
+                return false;
+            acc = acc * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        return true;
+    }
+
+    // One or more non-empty alphanumeric labels joined by '.', at least min_labels of them.
+    bool isDottedLabels(std::string_view s, int min_labels)
+    {
+        int labels = 0;
+        std::size_t label_len = 0;
+
+        for (char c : s)
+        {
+            if (c == '.')
+            {
+                if (label_len == 0)
+                    return false;
+                ++labels;
+                label_len = 0;
+            }
+            else if (isAsciiAlnum(c))
+            {
+                ++label_len;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        if (label_len == 0)
+            return false;
+        return labels + 1 >= min_labels;
+    }
+
+    // How a phone number was spelled, kept so it can be printed back the same way.
+    enum PhoneLayout : std::uint64_t { Plain, Parenthesized, Dashed };
+
+    struct ParsedPhone
+    {
+        std::uint64_t digits = 0;
+        PhoneLayout   layout = Plain;
+        bool          plus7  = false;
+    };
+
+    // ^(?:\+7|8)(?:\d{10}|\(\d{3}\)\d{7}|\(\d{3}\)\d{3}-\d{2}-\d{2})$
+    bool parsePhoneNumber(std::string_view v, ParsedPhone& out)
+    {
+        if (v.empty() || !isPhoneCharset(v))
+            return false;
+
+        out = ParsedPhone{};
+        if (v.compare(0, 2, "+7") == 0)
+        {
+            out.plus7 = true;
+            v.remove_prefix(2);
+        }
+        else if (v.compare(0, 1, "8") == 0)
+        {
+            v.remove_prefix(1);
+        }
+        else
+        {
+            return false;
+        }
+
+        switch (v.size())
+        {
+        case 10:
+            out.layout = Plain;
+            return takeDigits(v, out.digits);
+        case 12:
+            out.layout = Parenthesized;
+            return v[0] == '(' && takeDigits(v.substr(1, 3), out.digits) && v[4] == ')' &&
+                   takeDigits(v.substr(5, 7), out.digits);
+        case 14:
+            out.layout = Dashed;
+            return v[0] == '(' && takeDigits(v.substr(1, 3), out.digits) && v[4] == ')' &&
+                   takeDigits(v.substr(5, 3), out.digits) && v[8] == '-' &&
+                   takeDigits(v.substr(9, 2), out.digits) && v[11] == '-' &&
+                   takeDigits(v.substr(12, 2), out.digits);
+        default:
+            return false;
+        }
+    }
+
+    bool isValidPhoneNumber(const std::string& raw_number)
+    {
+        ParsedPhone parsed;
+        return parsePhoneNumber(trimView(raw_number), parsed);
+    }
+
+    // PackedPhone bit layout: 34 bits of digits, then layout, prefix and type.
+    const std::uint64_t kDigitsMask  = (std::uint64_t{1} << 34) - 1;
+    const int           kLayoutShift = 34;
+    const int           kPlus7Shift  = 36;
+    const int           kTypeShift   = 37;
+
+    // Writes count digits of value, most significant first, ending just before end.
+    void putDigits(char* end, std::uint64_t value, int count)
+    {
+        for (int i = 1; i <= count; ++i)
+        {
+            end[-i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
+
+}
+
+bool Contact::setName             (std::string_view          raw_name)
+    {
+        std::string_view name = trimView(raw_name);
+
+        if (name.empty())
+            return false;
+
+        if (!isValidPersonalName(name))
+            return false;
+
+        name_ = PooledString(name);
+            return true;
+    }
+bool Contact::setSurname          (std::string_view          raw_surname)
+    {
+        std::string_view surname = trimView(raw_surname);
+
+        if (surname.empty())
+            return false;
+
+        if (!isValidPersonalName(surname))
+            return false;
+
+        surname_ = PooledString(surname);
+            return true;
+    }
+bool Contact::setPatronymic       (std::string_view          raw_patronymic)
+    {
+        std::string_view patronymic = trimView(raw_patronymic);
+
+        if (patronymic.empty())
+            return false;
+
+        if (!isValidPersonalName(patronymic))
+            return false;
+
+        patronymic_ = PooledString(patronymic);
+            return true;
+    }
+bool Contact::setEmail            (std::string_view          raw_email)
+    {
+    std::string_view all = trimView(raw_email);
+
+    std::size_t at_pos = all.find('@');
+    if (at_pos == std::string_view::npos) {
+        return false;
+    }
+
+    std::string_view user_part   = trimView(all.substr(0, at_pos));
+    std::string_view domain_part = trimView(all.substr(at_pos + 1));
+
+    if (user_part.empty() || domain_part.empty()) {
+        return false;
+    }
+
+    // Only spaces around '@' force a new string; otherwise the trimmed input is the result.
+    std::string joined;
+    std::string_view normalized = all;
+    if (user_part.size() + 1 + domain_part.size() != all.size()) {
+        joined.append(user_part).append(1, '@').append(domain_part);
+        normalized = joined;
+    }
+
+    if (!isValidEmail(normalized)) {
+        return false;
+    }
+
+    email_ = PooledString(normalized, PooledString::Stored);
+    return true;
+    }
+bool Contact::setDate             (const Date&               birth_date)
+    {
+    return setDate(birth_date, ValidationContext::now());
+    }
+bool Contact::setDate             (const Date&               birth_date, const ValidationContext& ctx)
+    {
+    if (!isValidDate(birth_date, ctx))
+            return false;
+
+    birth_date_ = birth_date;
+        return true;
+    }
+bool Contact::setPhones           (const std::vector<Phone>& phones)
+    {
+    if (!isValidPhones(phones)) {
+        return false;
+    }
+
+    phones_.clear();
+    for (const Phone& p : phones)
+        phones_.add(p.type, p.number);
+    return true;
+    }
+bool Contact::setPhones           (PhoneList&&               phones)
+    {
+    if (phones.empty())
+        return false;
+
+    phones_ = std::move(phones);
+    return true;
+    }
+
+
+// ^[[:alpha:]](?:[[:alnum:] -]*[[:alnum:]])?$
+bool Contact::isValidPersonalName (std::string_view          personal_name)
+{
+    PROFILE_SCOPE("validate.name");
+    if (personal_name.empty() || !isAsciiAlpha(personal_name.front()))
+        return false;
+
+    if (personal_name.size() == 1)
+        return true;
+
+    if (!isAsciiAlnum(personal_name.back()))
+        return false;
+
+    for (std::size_t i = 1; i + 1 < personal_name.size(); ++i)
+    {
+        char c = personal_name[i];
+        if (!isAsciiAlnum(c) && c != ' ' && c != '-')
+            return false;
+    }
+    return true;
+}
+// ^[A-Za-z0-9]+(\.[A-Za-z0-9]+)*@[A-Za-z0-9]+(\.[A-Za-z0-9]+)+$
+bool Contact::isValidEmail        (std::string_view          email)
+{
+    PROFILE_SCOPE("validate.email");
+    if (!isEmailCharset(email))
+        return false;
+
+    std::size_t at_pos = email.find('@');
+    if (at_pos == std::string_view::npos)
+        return false;
+
+    return isDottedLabels(email.substr(0, at_pos), 1) &&
+           isDottedLabels(email.substr(at_pos + 1), 2);
+}
+bool Contact::isValidDate         (const Date&               birth_date)
+{
+    return isValidDate(birth_date, ValidationContext::now());
+}
+bool Contact::isValidDate         (const Date&               birth_date, const ValidationContext& ctx)
+{
+    PROFILE_SCOPE("validate.date");
+    if (birth_date.month < 1 || birth_date.month > 12)
+        return false;
+
+    int maxDay = daysInMonth(birth_date.month, birth_date.year);
+    if (maxDay == 0)
+        return false;
+
+    if (birth_date.day < 1 || birth_date.day > maxDay)
+        return false;
+
+    const Date& today = ctx.today;
+
+    if (birth_date.year > today.year)
+        return false;
+
+    if (birth_date.year == today.year &&
+        birth_date.month > today.month)
+        return false;
+
+    if (birth_date.year == today.year &&
+        birth_date.month == today.month &&
+        birth_date.day >= today.day)
+        return false;
+
+    return true;
+}
+bool Contact::setAddress          (std::string_view          raw_address)
+{
+    std::string_view address = trimView(raw_address);
+    if (address.empty())
+        return false;
+    address_ = PooledString(address, PooledString::Stored);
+    return true;
+}
+bool Contact::isValidPhones       (const std::vector<Phone>& phones)
+{
+    PROFILE_SCOPE("validate.phones");
+    if (phones.empty())
+        return false;
+
+    for (const auto& p : phones) {
+        if (!isValidPhoneNumber(p.number)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Contact::Contact(std::string_view name, std::string_view surname, std::string_view email, const PhoneList& phones)
+    : name_(name),surname_(surname),patronymic_(),email_(email, PooledString::Stored),address_(),birth_date_{},phones_(phones) {}
+
+Contact::Contact(std::string_view name, std::string_view surname, std::string_view email, PhoneList&& phones)
+    : name_(name),surname_(surname),patronymic_(),email_(email, PooledString::Stored),address_(),birth_date_{},
+      phones_(std::move(phones)) {}
+
+Contact::Contact(std::string_view name, std::string_view surname, std::string_view patronymic, std::string_view email,
+                 std::string_view address, const Date& birth_date, const PhoneList& phones)
+    : name_(name),surname_(surname),patronymic_(patronymic),email_(email, PooledString::Stored),
+      address_(address, PooledString::Stored),birth_date_(birth_date),phones_(phones) {}
+
+Contact::Contact(std::string_view name, std::string_view surname, std::string_view patronymic, std::string_view email,
+                 std::string_view address, const Date& birth_date, PhoneList&& phones)
+    : name_(name),surname_(surname),patronymic_(patronymic),email_(email, PooledString::Stored),
+      address_(address, PooledString::Stored),birth_date_(birth_date),phones_(std::move(phones)) {}
+
+
+bool Contact::PackedPhone::pack(PhoneType type, std::string_view number, PackedPhone& out)
+{
+    ParsedPhone parsed;
+    if (!parsePhoneNumber(trimView(number), parsed))
+        return false;
+
+    out.bits_ = parsed.digits
+              | (static_cast<std::uint64_t>(parsed.layout) << kLayoutShift)
+              | (static_cast<std::uint64_t>(parsed.plus7)  << kPlus7Shift)
+              | (static_cast<std::uint64_t>(type)          << kTypeShift);
+    return true;
+}
+
+bool Contact::PackedPhone::fromBits(std::uint64_t bits, PackedPhone& out)
+{
+    if ((bits >> (kTypeShift + 2)) != 0 || (bits & kDigitsMask) > 9999999999ULL ||
+        ((bits >> kLayoutShift) & 3) > Dashed || ((bits >> kTypeShift) & 3) > static_cast<std::uint64_t>(PhoneType::Service))
+        return false;
+
+    out.bits_ = bits;
+    return true;
+}
+
+Contact::PhoneType Contact::PackedPhone::type() const noexcept
+{
+    return static_cast<PhoneType>((bits_ >> kTypeShift) & 3);
+}
+
+std::uint64_t Contact::PackedPhone::digits() const noexcept
+{
+    return bits_ & kDigitsMask;
+}
+
+std::size_t Contact::PackedPhone::format(char* out) const noexcept
+{
+    char* p = out;
+    if ((bits_ >> kPlus7Shift) & 1)
+    {
+        *p++ = '+';
+        *p++ = '7';
+    }
+    else
+    {
+        *p++ = '8';
+    }
+
+    std::uint64_t d = digits();
+    switch (static_cast<PhoneLayout>((bits_ >> kLayoutShift) & 3))
+    {
+    case Plain:
+        putDigits(p += 10, d, 10);
+        break;
+    case Parenthesized:
+        *p = '(';
+        putDigits(p + 4, d / 10000000, 3);
+        p[4] = ')';
+        putDigits(p += 12, d, 7);
+        break;
+    case Dashed:
+        *p = '(';
+        putDigits(p + 4, d / 10000000, 3);
+        p[4] = ')';
+        putDigits(p + 8, d / 10000, 3);
+        p[8] = '-';
+        putDigits(p + 11, d / 100, 2);
+        p[11] = '-';
+        putDigits(p += 14, d, 2);
+        break;
+    }
+    return static_cast<std::size_t>(p - out);
+}
+
+std::string Contact::PackedPhone::number() const
+{
+    char buf[kMaxLength];
+    return std::string(buf, format(buf));
+}
+
+
+Contact::PhoneList::PhoneList(const PhoneList& other)
+{
+    *this = other;
+}
+
+Contact::PhoneList::PhoneList(PhoneList&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+Contact::PhoneList& Contact::PhoneList::operator=(const PhoneList& other)
+{
+    if (this == &other)
+        return *this;
+
+    if (other.size_ > capacity_)
+    {
+        heap_.reset(new PackedPhone[other.size_]);
+        capacity_ = other.size_;
+    }
+
+    PackedPhone* dst = heap_ ? heap_.get() : inline_;
+    std::copy(other.begin(), other.end(), dst);
+    size_ = other.size_;
+    return *this;
+}
+
+Contact::PhoneList& Contact::PhoneList::operator=(PhoneList&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    if (other.heap_)
+    {
+        heap_     = std::move(other.heap_);
+        capacity_ = other.capacity_;
+    }
+    else
+    {
+        PackedPhone* dst = heap_ ? heap_.get() : inline_;
+        std::copy(other.begin(), other.end(), dst);
+    }
+    size_ = other.size_;
+
+    other.size_     = 0;
+    other.capacity_ = kInline;
+    return *this;
+}
+
+void Contact::PhoneList::push_back(PackedPhone phone)
+{
+    if (size_ == capacity_)
+    {
+        std::uint32_t grown = capacity_ * 2;
+        std::unique_ptr<PackedPhone[]> bigger(new PackedPhone[grown]);
+        std::copy(begin(), end(), bigger.get());
+        heap_     = std::move(bigger);
+        capacity_ = grown;
+    }
+
+    (heap_ ? heap_.get() : inline_)[size_++] = phone;
+}
+
+bool Contact::PhoneList::add(PhoneType type, std::string_view number)
+{
+    PackedPhone phone;
+    if (!PackedPhone::pack(type, number, phone))
+        return false;
+
+    push_back(phone);
+    return true;
+}
+
+
+Contact::ValidationContext Contact::ValidationContext::now()
+{
+    std::time_t t = std::time(nullptr);
+    std::tm lt{};
+
+    // Reentrant conversion: dates are validated from the loader threads too.
+#ifdef _WIN32
+    localtime_s(&lt, &t);
+#else
+    localtime_r(&t, &lt);
+#endif
+
+    ValidationContext ctx{};
+    ctx.today.day   = lt.tm_mday;
+    ctx.today.month = lt.tm_mon + 1;
+    ctx.today.year  = lt.tm_year + 1900;
+    return ctx;
+}
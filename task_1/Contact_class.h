@@ -1,62 +1,145 @@
-#ifndef CONTACT_CLASS_H
-#define CONTACT_CLASS_H
-
-#include <string>
-#include <vector>
-
-
-class Contact
-{
-public:
-
-    struct Date
-    {
-        int day{};
-        int month{};
-        int year{};
-    };
-
-    enum class PhoneType {Work, Home, Service};
-    struct Phone
-    {
-        PhoneType   type;
-        std::string number;
-    };
-
-    Contact(const std::string& name,const std::string& surname,const std::string& email,const std::vector<Phone>& phones);
-
-    const std::string&       getName()       const noexcept {return name_;}
-    const std::string&       getSurname()    const noexcept {return surname_;}
-    const std::string&       getPatronymic() const noexcept {return patronymic_;}
-    const std::string&       getemail()      const noexcept {return email_;}
-    const Date&              getBirth_date() const noexcept {return birth_date_;}
-    const std::string&       getAddress()    const noexcept {return address_;}
-    const std::vector<Phone> getPhones()     const noexcept {return phones_;}
-
-    bool setName       (const std::string&         name);
-    bool setSurname    (const std::string&         surname);
-    bool setPatronymic (const std::string&         patronymic);
-    bool setEmail      (const std::string&         email);
-    bool setDate       (const Date&                birth_date);
-    bool setAddress    (const std::string&         address);
-    bool setPhones     (const::std::vector<Phone>& phones);
-
-    static bool isValidPersonalName (const std::string& name);
-    static bool isValidEmail        (const std::string& email);
-    static bool isValidDate         (const Date& birth_date);
-    static bool isValidPhones       (const std::vector<Phone>& phones);
-
-private:
-    std::string name_;
-    std::string surname_;
-    std::string patronymic_;
-    std::string email_;
-    std::string address_;
-    Date birth_date_;
-    std::vector<Phone> phones_;
-};
-
-
-
-
-#endif // CONTACT_CLASS_H
+#ifndef CONTACT_CLASS_H
+#define CONTACT_CLASS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "string_pool.h"
+
+
+class Contact
+{
+public:
+
+    struct Date
+    {
+        int day{};
+        int month{};
+        int year{};
+    };
+
+    // "Today" read once for a whole batch of validations, so each date check is
+    // a few integer compares. now() uses a thread-safe clock conversion.
+    struct ValidationContext
+    {
+        Date today;
+
+        static ValidationContext now();
+    };
+
+    enum class PhoneType {Work, Home, Service};
+    struct Phone
+    {
+        PhoneType   type;
+        std::string number;
+    };
+
+    // A phone stored in 64 bits: its type, how the number was spelled (+7 or 8,
+    // plain, parenthesized or dashed) and the ten digits after the prefix.
+    // Only numbers accepted by isValidPhones can be packed; number() gives
+    // back the original spelling without surrounding whitespace.
+    class PackedPhone
+    {
+    public:
+        static constexpr std::size_t kMaxLength = 16;
+
+        static bool pack(PhoneType type, std::string_view number, PackedPhone& out);
+
+        // The raw 64 bits, for binary formats; fromBits rejects values pack never makes.
+        std::uint64_t bits() const noexcept { return bits_; }
+        static bool   fromBits(std::uint64_t bits, PackedPhone& out);
+
+        PhoneType     type()   const noexcept;
+        std::uint64_t digits() const noexcept;
+        std::size_t   format(char* out) const noexcept;   // writes at most kMaxLength chars
+        std::string   number() const;
+        Phone         unpack() const { return Phone{ type(), number() }; }
+
+    private:
+        std::uint64_t bits_ = 0;
+    };
+
+    // Phone list that keeps up to kInline phones inside the contact and only
+    // allocates for longer lists.
+    class PhoneList
+    {
+    public:
+        static constexpr std::size_t kInline = 3;
+
+        PhoneList() = default;
+        PhoneList(const PhoneList& other);
+        PhoneList(PhoneList&& other) noexcept;
+        PhoneList& operator=(const PhoneList& other);
+        PhoneList& operator=(PhoneList&& other) noexcept;
+
+        void push_back(PackedPhone phone);
+        bool add(PhoneType type, std::string_view number);   // false if the number cannot be packed
+        void clear() noexcept { size_ = 0; }
+
+        std::size_t        size()  const noexcept { return size_; }
+        bool               empty() const noexcept { return size_ == 0; }
+        const PackedPhone* begin() const noexcept { return data(); }
+        const PackedPhone* end()   const noexcept { return data() + size_; }
+        const PackedPhone& operator[](std::size_t i) const noexcept { return data()[i]; }
+
+    private:
+        const PackedPhone* data() const noexcept { return heap_ ? heap_.get() : inline_; }
+
+        PackedPhone                    inline_[kInline];
+        std::unique_ptr<PackedPhone[]> heap_;
+        std::uint32_t                  size_     = 0;
+        std::uint32_t                  capacity_ = kInline;
+    };
+
+    // Text fields live in the StringPool: names are interned, e-mail and address
+    // are copied into the arena. Phones come packed, so every number was checked
+    // by PhoneList::add (or isValidPhones) before the contact is built.
+    Contact(std::string_view name,std::string_view surname,std::string_view email,const PhoneList& phones);
+    Contact(std::string_view name,std::string_view surname,std::string_view email,PhoneList&& phones);
+    // Takes every field as is, without validation: for data that was validated before it was stored.
+    Contact(std::string_view name,std::string_view surname,std::string_view patronymic,std::string_view email,
+            std::string_view address,const Date& birth_date,const PhoneList& phones);
+    Contact(std::string_view name,std::string_view surname,std::string_view patronymic,std::string_view email,
+            std::string_view address,const Date& birth_date,PhoneList&& phones);
+
+    std::string_view          getName()       const noexcept {return name_;}
+    std::string_view          getSurname()    const noexcept {return surname_;}
+    std::string_view          getPatronymic() const noexcept {return patronymic_;}
+    std::string_view          getemail()      const noexcept {return email_;}
+    const Date&               getBirth_date() const noexcept {return birth_date_;}
+    std::string_view          getAddress()    const noexcept {return address_;}
+    const PhoneList&          getPhones()     const noexcept {return phones_;}
+
+    bool setName       (std::string_view           name);
+    bool setSurname    (std::string_view           surname);
+    bool setPatronymic (std::string_view           patronymic);
+    bool setEmail      (std::string_view           email);
+    bool setDate       (const Date&                birth_date);
+    bool setDate       (const Date&                birth_date, const ValidationContext& ctx);
+    bool setAddress    (std::string_view           address);
+    bool setPhones     (const::std::vector<Phone>& phones);
+    bool setPhones     (PhoneList&&                phones);   // false if the list is empty
+
+    static bool isValidPersonalName (std::string_view name);
+    static bool isValidEmail        (std::string_view email);
+    static bool isValidDate         (const Date& birth_date);
+    static bool isValidDate         (const Date& birth_date, const ValidationContext& ctx);
+    static bool isValidPhones       (const std::vector<Phone>& phones);
+
+private:
+    PooledString name_;
+    PooledString surname_;
+    PooledString patronymic_;
+    PooledString email_;
+    PooledString address_;
+    Date birth_date_;
+    PhoneList phones_;
+};
+
+
+
+
+#endif // CONTACT_CLASS_H
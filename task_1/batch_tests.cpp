@@ -0,0 +1,38 @@
+#include "contact_batch.h"
+#include "contact_tests.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    int batch(std::vector<std::string> args)
+    {
+        args.insert(args.begin(), "contacts");
+        std::vector<char*> argv;
+        for (std::string& a : args)
+            argv.push_back(&a[0]);
+        argv.push_back(nullptr);
+        return runBatch(static_cast<int>(args.size()), argv.data());
+    }
+}
+
+TEST(batch_import_fails_for_a_source_it_cannot_read)
+{
+    tests::TempDir dir("batch_import");
+    std::string contacts = dir.file("contacts.txt");
+    std::string source   = dir.file("source.txt");
+    {
+        std::ofstream out(source);
+        out << "Ivan|Petrov|Ivanovich|Moscow|01.01.1990|ivan@mail.ru|Work:89991234567\n";
+    }
+
+    CHECK_EQ(batch({ "--file", contacts, "--import", dir.file("missing.txt") }), 1);
+    CHECK_EQ(batch({ "--file", contacts, "--import", dir.file("") }), 1);
+    CHECK(!std::filesystem::exists(contacts + ".journal"));
+
+    CHECK_EQ(batch({ "--file", contacts, "--import", source }), 0);
+    CHECK(std::filesystem::exists(contacts + ".journal"));
+}
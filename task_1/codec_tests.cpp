@@ -0,0 +1,108 @@
+#include "contact_codec.h"
+#include "contact_tests.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The codecs replaced ostringstream/istringstream code. Dates must print as
+// before, read back to the same values, and the parser must accept exactly
+// the records the stream parser accepted.
+
+namespace
+{
+    // The former implementations, kept as the reference.
+    std::string streamFormat(const Contact::Date& d)
+    {
+        std::ostringstream os;
+        if (d.day < 10)   os << '0';
+        os << d.day << '.';
+        if (d.month < 10) os << '0';
+        os << d.month << '.';
+        os << d.year;
+        return os.str();
+    }
+
+    bool streamParse(const std::string& text, Contact::Date& out)
+    {
+        std::istringstream is(text);
+        char dot1 = 0, dot2 = 0;
+        if (!(is >> out.day >> dot1 >> out.month >> dot2 >> out.year))
+            return false;
+        return dot1 == '.' && dot2 == '.';
+    }
+
+    // Every concatenation of up to maxParts fragments.
+    void concatenations(const std::vector<std::string>& fragments, std::size_t maxParts,
+                        const std::string& prefix, std::vector<std::string>& out)
+    {
+        out.push_back(prefix);
+        if (maxParts == 0)
+            return;
+        for (const std::string& f : fragments)
+            concatenations(fragments, maxParts - 1, prefix + f, out);
+    }
+}
+
+TEST(dates_round_trip)
+{
+    std::size_t mismatches = 0;
+    for (int year = -10; year <= 10000; ++year)
+    {
+        for (int month = 1; month <= 12; ++month)
+        {
+            for (int day = 1; day <= 31; ++day)
+            {
+                Contact::Date date{day, month, year};
+                std::string text;
+                appendDate(text, date);
+
+                Contact::Date back{};
+                bool same = text == streamFormat(date) && parseDate(text, back) &&
+                            back.day == day && back.month == month && back.year == year;
+                if (!same && ++mismatches <= 5)
+                    tests::fail(__FILE__, __LINE__, "date " + text + " does not round-trip");
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0u);
+}
+
+TEST(date_parser_matches_stream_parser)
+{
+    std::vector<std::string> inputs = {
+        "01.02.2003", " 1.2.2003", "1 . 2 . 2003", "\t01.\n02.\v2003 ", "+1.+2.+2003", "-1.-2.-2003",
+        "1.2.2003x", "1.2.2003.4", "1.2.2003 junk", "+-1.2.2003", "-+1.2.2003", "+ 1.2.2003", "1..2.2003",
+        "1.2.", "1.2", ".1.2.2003", "2147483647.1.1", "2147483648.1.1", "1.1.-2147483648", "0x1.2.3", "",
+    };
+    concatenations({ "1", "+07", "-1", "+", " ", ".", "1.", "\t2.", "x", "2147483648" }, 5, "", inputs);
+
+    std::size_t mismatches = 0;
+    for (const std::string& text : inputs)
+    {
+        Contact::Date expected{}, actual{};
+        bool expectedOk = streamParse(text, expected);
+        bool actualOk   = parseDate(text, actual);
+        bool same = expectedOk == actualOk &&
+                    (!expectedOk || (expected.day == actual.day && expected.month == actual.month &&
+                                     expected.year == actual.year));
+        if (!same && ++mismatches <= 5)
+            tests::fail(__FILE__, __LINE__, "'" + text + "': stream parser says " + (expectedOk ? "valid" : "invalid"));
+    }
+    CHECK_EQ(mismatches, 0u);
+    CHECK(inputs.size() > 100000);
+}
+
+TEST(phone_types_round_trip)
+{
+    for (Contact::PhoneType type : { Contact::PhoneType::Work, Contact::PhoneType::Home, Contact::PhoneType::Service })
+    {
+        Contact::PhoneType back = type == Contact::PhoneType::Work ? Contact::PhoneType::Home : Contact::PhoneType::Work;
+        CHECK(parsePhoneType(phoneTypeName(type), back));
+        CHECK(back == type);
+    }
+
+    Contact::PhoneType type;
+    for (const char* name : { "", "work", "Home ", " Home", "Unknown", "Services" })
+        CHECK(!parsePhoneType(name, type));
+}
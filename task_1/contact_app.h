@@ -1,17 +1,29 @@
-#ifndef CONTACT_APP_H
-#define CONTACT_APP_H
-
-#include <vector>
-#include "Contact_class.h"
-
-void showContacts  (const std::vector<Contact>& contacts);
-
-void addContact    (std::vector<Contact>& contacts);
-
-void deleteContact (std::vector<Contact>& contacts);
-
-void editContact   (std::vector<Contact>& contacts);
-
-void searchContact (const std::vector<Contact>& contacts);
-
-#endif // CONTACT_APP_H
+#ifndef CONTACT_APP_H
+#define CONTACT_APP_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Contact_class.h"
+#include "contact_store.h"
+
+// Number of contacts browseContacts shows before asking to go on.
+const std::size_t kPageSize = 50;
+
+// Shows at most limit contacts starting at offset; cards keep their position in the list as number.
+void showContacts  (const std::vector<Contact>& contacts,
+                    std::size_t                 offset = 0,
+                    std::size_t                 limit  = std::string::npos);
+
+// Shows the whole store page by page.
+void browseContacts(const ContactStore& store);
+
+void addContact    (ContactStore&       store);
+
+void deleteContact (ContactStore&       store);
+
+void editContact   (ContactStore&       store);
+
+void searchContact (const ContactStore& store);
+
+#endif // CONTACT_APP_H
@@ -0,0 +1,344 @@
+#include "contact_batch.h"
+#include "contact_server.h"
+#include "contact_snapshot.h"
+#include "contact_storage.h"
+#include "contact_store.h"
+#include "contact_writer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    void printUsage(std::ostream& os)
+    {
+        os << "Usage: contacts [--file <path>] [operation...]\n"
+              "  --import <path>             add or update every record of a file\n"
+              "  --delete-by-email <path>    delete contacts listed by e-mail, one per line\n"
+              "  --export <path>             write every contact as a record ('-' for stdout)\n"
+              "  --export-snapshot <path>    write every contact to a binary snapshot\n"
+              "  --query <field>=<value>     print matches (field: email, name, surname, phone,\n"
+              "                              fuzzy; surname=Iva* and phone=999* match by prefix,\n"
+              "                              fuzzy=<words> allows typos, best first)\n"
+              "  --limit <n>                 print at most n matches per later query (0: no limit)\n"
+              "  --workers <n>               worker threads for --serve (0: one per CPU)\n"
+              "  --serve <socket>            answer lookups on a UNIX socket until interrupted\n";
+    }
+
+    bool parseCount(const std::string& text, unsigned long long& value)
+    {
+        std::istringstream in(text);
+        return (in >> value) && in.eof();
+    }
+
+    std::string_view trim(std::string_view str)
+    {
+        const char* ws = " \t\n\r\f\v";
+        std::size_t first = str.find_first_not_of(ws);
+        if (first == std::string_view::npos)
+            return {};
+
+        std::size_t last = str.find_last_not_of(ws);
+        return str.substr(first, last - first + 1);
+    }
+
+    bool importFile(ContactStore& store, const std::string& path)
+    {
+        // The loader reads a missing file as an empty one; a source to import must exist.
+        std::vector<Contact>     records;
+        std::vector<std::string> rejected;
+        std::error_code          ec;
+        if (!std::filesystem::exists(path, ec) || !loadContactsParallel(path, records, 0, nullptr, &rejected))
+        {
+            std::cerr << "Cannot read " << path << ".\n";
+            return false;
+        }
+
+        std::size_t added = 0, updated = 0;
+        for (Contact& c : records)
+        {
+            ContactStore::Handle h = store.findByEmail(c.getemail());
+            if (h == ContactStore::npos)
+            {
+                store.add(std::move(c));
+                ++added;
+            }
+            else
+            {
+                store.replace(h, std::move(c));
+                ++updated;
+            }
+        }
+
+        std::cerr << path << ": " << added << " added, " << updated << " updated";
+        if (!rejected.empty())
+            std::cerr << ", " << rejected.size() << " skipped for a phone number that cannot be stored";
+        std::cerr << ".\n";
+        return true;
+    }
+
+    bool deleteListed(ContactStore& store, const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in.is_open())
+        {
+            std::cerr << "Cannot read " << path << ".\n";
+            return false;
+        }
+
+        std::size_t deleted = 0, missing = 0;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::string_view email = trim(line);
+            if (email.empty())
+                continue;
+
+            ContactStore::Handle h = store.findByEmail(email);
+            if (h == ContactStore::npos)
+            {
+                ++missing;
+                continue;
+            }
+
+            store.remove(h);
+            ++deleted;
+        }
+
+        std::cerr << path << ": " << deleted << " deleted, " << missing << " not found.\n";
+        return true;
+    }
+
+    bool exportAll(const ContactStore& store, const std::string& path)
+    {
+        if (path == "-")
+        {
+            ContactWriter out(std::cout);
+            for (const Contact& c : store.contacts())
+                out.record(c);
+            return true;
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Cannot write " << path << ".\n";
+            return false;
+        }
+
+        {
+            ContactWriter out(file);
+            for (const Contact& c : store.contacts())
+                out.record(c);
+        }
+
+        if (!file)
+        {
+            std::cerr << "Cannot write " << path << ".\n";
+            return false;
+        }
+        std::cerr << path << ": " << store.size() << " exported.\n";
+        return true;
+    }
+
+    bool exportSnapshot(const ContactStore& store, const std::string& path)
+    {
+        if (!saveSnapshot(path, store.contacts()))
+        {
+            std::cerr << "Cannot write " << path << ".\n";
+            return false;
+        }
+        std::cerr << path << ": " << store.size() << " exported.\n";
+        return true;
+    }
+
+    bool runQuery(const ContactStore& store, std::string_view query, std::size_t limit)
+    {
+        std::size_t eq = query.find('=');
+        if (eq == std::string_view::npos)
+        {
+            std::cerr << "Query must look like <field>=<value>.\n";
+            return false;
+        }
+
+        std::string_view field = trim(query.substr(0, eq));
+        std::string_view value = trim(query.substr(eq + 1));
+
+        ContactWriter out(std::cout);
+        auto print = [&](ContactStore::Handle, const Contact& c) { out.record(c); return true; };
+
+        if (field == "email")
+        {
+            ContactStore::Handle h = store.findByEmail(value);
+            if (h != ContactStore::npos)
+                print(h, store.at(h));
+        }
+        else if (field == "surname")
+        {
+            bool prefix = !value.empty() && value.back() == '*';
+            if (prefix)
+            {
+                value.remove_suffix(1);
+                store.visitBySurnamePrefix(value, print, limit);
+            }
+            else
+            {
+                // An exact surname is the index range [value, value + '\0').
+                std::string to(value);
+                to += '\0';
+                store.visitBySurnameRange(value, to, print, limit);
+            }
+        }
+        else if (field == "phone")
+        {
+            bool prefix = !value.empty() && value.back() == '*';
+            if (prefix)
+            {
+                value.remove_suffix(1);
+                if (!store.visitByPhonePrefix(value, print, limit))
+                {
+                    std::cerr << "Invalid phone prefix '" << value << "'.\n";
+                    return false;
+                }
+            }
+            else
+            {
+                std::vector<ContactStore::Handle> found = store.findByPhone(value);
+                for (std::size_t i = 0; i < found.size() && i < limit; ++i)
+                    print(found[i], store.at(found[i]));
+            }
+        }
+        else if (field == "fuzzy")
+        {
+            // Without a limit only the ten best matches are printed.
+            std::size_t top = limit == ContactStore::npos ? 10 : limit;
+            for (const FuzzyIndex::Match& m : store.findSimilar(value, top))
+                print(m.handle, store.at(m.handle));
+        }
+        else if (field == "name")
+        {
+            std::size_t printed = 0;
+            for (ContactStore::Handle h = 0; h < store.size() && printed < limit; ++h)
+            {
+                if (store.at(h).getName() == value)
+                {
+                    print(h, store.at(h));
+                    ++printed;
+                }
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown query field '" << field << "'.\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+int runBatch(int argc, char** argv)
+{
+    std::ios::sync_with_stdio(false);
+
+    // The whole command line is checked before the contacts file is loaded, so
+    // a typo or --help costs nothing.
+    struct Step
+    {
+        std::string_view   op;
+        std::string        arg;
+        unsigned long long count = 0;
+    };
+
+    std::string       filename = "contacts.txt";
+    std::vector<Step> steps;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view op = argv[i];
+
+        if (op == "--help" || op == "-h")
+        {
+            printUsage(std::cout);
+            return 0;
+        }
+
+        if (op != "--file" && op != "--import" && op != "--delete-by-email" && op != "--query" &&
+            op != "--limit" && op != "--workers" && op != "--serve" && op != "--export" && op != "--export-snapshot")
+        {
+            std::cerr << "Unknown option " << op << ".\n";
+            printUsage(std::cerr);
+            return 1;
+        }
+
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing argument for " << op << ".\n";
+            return 1;
+        }
+        Step step{ op, argv[++i] };
+
+        if ((op == "--limit" || op == "--workers") && !parseCount(step.arg, step.count))
+        {
+            std::cerr << op << " takes a number.\n";
+            return 1;
+        }
+
+        if (op == "--file")
+            filename = step.arg;
+        else
+            steps.push_back(std::move(step));
+    }
+
+    ContactStore store;
+    if (!store.open(filename))
+    {
+        std::cerr << "Cannot load " << filename << ".\n";
+        return 1;
+    }
+    if (store.rejected() != 0)
+    {
+        std::cerr << store.rejected() << " records could not be loaded and were moved to "
+                  << store.rejectedName() << ".\n";
+    }
+
+    std::size_t limit   = ContactStore::npos;
+    unsigned    workers = 0;
+
+    bool ok = true;
+    for (std::size_t i = 0; i < steps.size() && ok; ++i)
+    {
+        std::string_view   op  = steps[i].op;
+        const std::string& arg = steps[i].arg;
+
+        if (op == "--import")
+            ok = importFile(store, arg);
+        else if (op == "--delete-by-email")
+            ok = deleteListed(store, arg);
+        else if (op == "--query")
+            ok = runQuery(store, arg, limit);
+        else if (op == "--limit")
+            limit = steps[i].count == 0 ? ContactStore::npos : static_cast<std::size_t>(steps[i].count);
+        else if (op == "--workers")
+            workers = static_cast<unsigned>(steps[i].count);
+        else if (op == "--serve")
+            ok = runServer(store, arg, workers) == 0;
+        else if (op == "--export")
+            ok = exportAll(store, arg);
+        else if (op == "--export-snapshot")
+            ok = exportSnapshot(store, arg);
+    }
+
+    std::cout.flush();
+
+    // Everything done so far is written in one go, even if a later step failed.
+    if (!store.commit())
+    {
+        std::cerr << "Cannot save " << filename << ".\n";
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
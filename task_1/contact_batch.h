@@ -0,0 +1,21 @@
+#ifndef CONTACT_BATCH_H
+#define CONTACT_BATCH_H
+
+// Non-interactive mode: applies the operations given on the command line in
+// order, streams query results to stdout as contacts.txt records and commits
+// the store once at the end. Returns the process exit code.
+//
+//   --file <path>               contacts file to work on (default contacts.txt)
+//   --import <path>             add or update every record of a text file or snapshot
+//   --delete-by-email <path>    delete the contacts whose e-mails are listed, one per line
+//   --export <path>             write every contact as a record; '-' writes to stdout
+//   --query <field>=<value>     print matches; field is email, name, surname, phone or
+//                               fuzzy, a surname or phone ending in '*' matches by prefix
+//                               and fuzzy prints the ten (or --limit) closest names
+//                               allowing typos
+//   --limit <n>                 later queries print at most n matches; 0 lifts the limit
+//   --workers <n>               worker threads for --serve; 0 starts one per CPU
+//   --serve <socket>            run the lookup server of contact_server.h until interrupted
+int runBatch(int argc, char** argv);
+
+#endif // CONTACT_BATCH_H
@@ -0,0 +1,664 @@
+// Microbenchmarks over deterministic synthetic data (contact_dataset.h).
+// Every benchmark is run with doubling iteration counts until one run takes at
+// least --min-time seconds; that run is reported as time per operation and
+// items per second, the way Google Benchmark does.
+//
+//   benchmarks [--sizes 10000,1000000] [--filter <substring>] [--min-time 0.5]
+//              [--dir <scratch directory>]
+//   benchmarks generate <count> <file> [seed]
+
+#include "Contact_class.h"
+#include "contact_dataset.h"
+#include "contact_shared_store.h"
+#include "contact_snapshot.h"
+#include "contact_storage.h"
+#include "contact_store.h"
+#include "contact_table.h"
+#include "contact_writer.h"
+#include "phone_index.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps the compiler from dropping a computation whose result is unused.
+    template <typename T>
+    void doNotOptimize(const T& value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    // One timed run: the body loops while keepRunning() is true.
+    class State
+    {
+    public:
+        explicit State(std::uint64_t iterations) : left_(iterations), iterations_(iterations) {}
+
+        bool keepRunning()
+        {
+            if (!started_)
+            {
+                started_ = true;
+                start_   = Clock::now();
+            }
+            if (left_ == 0)
+            {
+                elapsed_ = Clock::now() - start_;
+                return false;
+            }
+            --left_;
+            return true;
+        }
+
+        // Items handled per iteration, for the items/s column.
+        void setItemsPerIteration(std::uint64_t items) { items_ = items; }
+
+        std::uint64_t  iterations() const { return iterations_; }
+        std::uint64_t  items()      const { return items_ * iterations_; }
+        Clock::duration elapsed()   const { return elapsed_; }
+
+    private:
+        std::uint64_t   left_;
+        std::uint64_t   iterations_;
+        std::uint64_t   items_   = 1;
+        bool            started_ = false;
+        Clock::time_point start_;
+        Clock::duration   elapsed_{};
+    };
+
+    // Drops everything written to it; output benchmarks measure formatting only.
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+        int_type        overflow(int_type c) override { return traits_type::not_eof(c); }
+    };
+
+    // Data shared by the benchmarks of one dataset size, built on first use.
+    class Fixture
+    {
+    public:
+        Fixture(std::size_t size, std::string dir)
+            : size_(size), dir_(std::move(dir))
+        {
+        }
+
+        ~Fixture()
+        {
+            for (const std::string& file : files_)
+                std::remove(file.c_str());
+        }
+
+        std::size_t size() const { return size_; }
+
+        const std::vector<Contact>& contacts()
+        {
+            if (contacts_.empty())
+                contacts_ = syntheticContacts(size_);
+            return contacts_;
+        }
+
+        const std::string& textFile()
+        {
+            if (textFile_.empty())
+            {
+                textFile_ = scratch("txt");
+                writeSyntheticContacts(textFile_, size_);
+            }
+            return textFile_;
+        }
+
+        const std::string& snapshotFile()
+        {
+            if (snapshotFile_.empty())
+            {
+                snapshotFile_ = scratch("snap");
+                saveSnapshot(snapshotFile_, contacts());
+            }
+            return snapshotFile_;
+        }
+
+        const ContactStore& store()
+        {
+            if (!store_)
+            {
+                store_ = std::make_unique<ContactStore>();
+                store_->open(textFile());
+            }
+            return *store_;
+        }
+
+        SharedContactStore& shared()
+        {
+            if (!shared_)
+                shared_ = std::make_unique<SharedContactStore>(contacts());
+            return *shared_;
+        }
+
+        const ContactTable& table()
+        {
+            if (!table_)
+                table_ = std::make_unique<ContactTable>(ContactTable::fromContacts(contacts()));
+            return *table_;
+        }
+
+        // A fixed spread of records to look up, the same for every run.
+        const std::vector<const Contact*>& sample()
+        {
+            if (sample_.empty())
+            {
+                const std::vector<Contact>& all = contacts();
+                std::uint64_t x = 0x2545F4914F6CDD1DULL;
+                for (int i = 0; i < 4096; ++i)
+                {
+                    x ^= x << 13;
+                    x ^= x >> 7;
+                    x ^= x << 17;
+                    sample_.push_back(&all[x % all.size()]);
+                }
+            }
+            return sample_;
+        }
+
+        std::string scratch(const char* extension)
+        {
+            std::string file = dir_ + "/bench-" + std::to_string(size_) + "." + extension;
+            files_.push_back(file);
+            return file;
+        }
+
+    private:
+        std::size_t                         size_;
+        std::string                         dir_;
+        std::vector<std::string>            files_;
+        std::vector<Contact>                contacts_;
+        std::string                         textFile_;
+        std::string                         snapshotFile_;
+        std::unique_ptr<ContactStore>       store_;
+        std::unique_ptr<SharedContactStore> shared_;
+        std::unique_ptr<ContactTable>       table_;
+        std::vector<const Contact*>         sample_;
+    };
+
+    using BenchmarkFunction = std::function<void(State&, Fixture&)>;
+
+    struct Benchmark
+    {
+        std::string       name;
+        BenchmarkFunction run;
+    };
+
+    // Swaps two inner letters, the commonest typo.
+    std::string misspell(std::string_view word)
+    {
+        std::string typo(word);
+        if (typo.size() > 3)
+            std::swap(typo[1], typo[2]);
+        return typo;
+    }
+
+    std::vector<Benchmark> benchmarks()
+    {
+        std::vector<Benchmark> list;
+        auto add = [&](std::string name, BenchmarkFunction run) { list.push_back(Benchmark{ std::move(name), std::move(run) }); };
+
+        add("dataset/generate", [](State& state, Fixture& f)
+        {
+            std::string line;
+            std::uint64_t i = 0;
+            while (state.keepRunning())
+            {
+                line.clear();
+                appendSyntheticRecord(line, i++ % f.size());
+                doNotOptimize(line);
+            }
+        });
+
+        // Storage: whole-file operations, one item per record.
+        add("load/text", [](State& state, Fixture& f)
+        {
+            const std::string& file = f.textFile();
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+            {
+                std::vector<Contact> contacts;
+                loadContacts(file, contacts);
+                doNotOptimize(contacts.data());
+            }
+        });
+
+        add("load/text-parallel", [](State& state, Fixture& f)
+        {
+            const std::string& file = f.textFile();
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+            {
+                std::vector<Contact> contacts;
+                loadContactsParallel(file, contacts);
+                doNotOptimize(contacts.data());
+            }
+        });
+
+        add("load/snapshot", [](State& state, Fixture& f)
+        {
+            const std::string& file = f.snapshotFile();
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+            {
+                std::vector<Contact> contacts;
+                loadContacts(file, contacts);
+                doNotOptimize(contacts.data());
+            }
+        });
+
+        add("save/text", [](State& state, Fixture& f)
+        {
+            const std::vector<Contact>& contacts = f.contacts();
+            std::string file = f.scratch("out.txt");
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+                saveContacts(file, contacts);
+        });
+
+        add("save/snapshot", [](State& state, Fixture& f)
+        {
+            const std::vector<Contact>& contacts = f.contacts();
+            std::string file = f.scratch("out.snap");
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+                saveSnapshot(file, contacts);
+        });
+
+        // Per-record parsing and validation over the lookup sample.
+        add("parse/line", [](State& state, Fixture& f)
+        {
+            std::vector<std::string> lines;
+            for (const Contact* c : f.sample())
+                lines.push_back(formatContactLine(*c));
+
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(parseContactLine(lines[i++ % lines.size()]));
+        });
+
+        add("validate/name", [](State& state, Fixture& f)
+        {
+            const std::vector<const Contact*>& sample = f.sample();
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(Contact::isValidPersonalName(sample[i++ % sample.size()]->getSurname()));
+        });
+
+        add("validate/email", [](State& state, Fixture& f)
+        {
+            const std::vector<const Contact*>& sample = f.sample();
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(Contact::isValidEmail(sample[i++ % sample.size()]->getemail()));
+        });
+
+        add("validate/date", [](State& state, Fixture& f)
+        {
+            const std::vector<const Contact*>& sample = f.sample();
+            Contact::ValidationContext ctx = Contact::ValidationContext::now();
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(Contact::isValidDate(sample[i++ % sample.size()]->getBirth_date(), ctx));
+        });
+
+        add("validate/phones", [](State& state, Fixture& f)
+        {
+            std::vector<std::vector<Contact::Phone>> phones;
+            for (const Contact* c : f.sample())
+            {
+                phones.emplace_back();
+                for (const Contact::PackedPhone& p : c->getPhones())
+                    phones.back().push_back(p.unpack());
+            }
+
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(Contact::isValidPhones(phones[i++ % phones.size()]));
+        });
+
+        // Indexed lookups in ContactStore.
+        add("lookup/email", [](State& state, Fixture& f)
+        {
+            const ContactStore& store = f.store();
+            const std::vector<const Contact*>& sample = f.sample();
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(store.findByEmail(sample[i++ % sample.size()]->getemail()));
+        });
+
+        add("lookup/name", [](State& state, Fixture& f)
+        {
+            const ContactStore& store = f.store();
+            const std::vector<const Contact*>& sample = f.sample();
+            std::size_t i = 0;
+            while (state.keepRunning())
+            {
+                const Contact* c = sample[i++ % sample.size()];
+                doNotOptimize(store.findByName(c->getSurname(), c->getName()));
+            }
+        });
+
+        add("lookup/surname-prefix-50", [](State& state, Fixture& f)
+        {
+            const ContactStore& store = f.store();
+            const std::vector<const Contact*>& sample = f.sample();
+            std::size_t i = 0;
+            while (state.keepRunning())
+            {
+                std::string_view prefix = sample[i++ % sample.size()]->getSurname().substr(0, 3);
+                std::size_t seen = store.visitBySurnamePrefix(prefix, [](ContactStore::Handle, const Contact&) { return true; }, 50);
+                doNotOptimize(seen);
+            }
+        });
+
+        add("lookup/fuzzy-50", [](State& state, Fixture& f)
+        {
+            const ContactStore& store = f.store();
+            std::vector<std::string> queries;
+            for (const Contact* c : f.sample())
+                queries.push_back(misspell(c->getName()) + " " + misspell(c->getSurname()));
+
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(store.findSimilar(queries[i++ % queries.size()], 50));
+        });
+
+        add("lookup/phone", [](State& state, Fixture& f)
+        {
+            const ContactStore& store = f.store();
+            std::vector<std::string> numbers;
+            for (const Contact* c : f.sample())
+                numbers.push_back(c->getPhones()[0].number());
+
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(store.findByPhone(numbers[i++ % numbers.size()]));
+        });
+
+        // Column scans against the same filter over the Contact vector.
+        add("scan/surname-vector", [](State& state, Fixture& f)
+        {
+            const std::vector<Contact>& contacts = f.contacts();
+            std::string_view surname = f.sample()[0]->getSurname();
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+            {
+                std::vector<std::size_t> rows;
+                for (std::size_t r = 0; r < contacts.size(); ++r)
+                {
+                    if (contacts[r].getSurname() == surname)
+                        rows.push_back(r);
+                }
+                doNotOptimize(rows.data());
+            }
+        });
+
+        add("scan/surname-table", [](State& state, Fixture& f)
+        {
+            const ContactTable& table = f.table();
+            std::string_view surname = f.sample()[0]->getSurname();
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+                doNotOptimize(table.findBySurname(surname));
+        });
+
+        add("scan/born-vector", [](State& state, Fixture& f)
+        {
+            const std::vector<Contact>& contacts = f.contacts();
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+            {
+                std::vector<std::size_t> rows;
+                for (std::size_t r = 0; r < contacts.size(); ++r)
+                {
+                    const Contact::Date& d = contacts[r].getBirth_date();
+                    if (d.year >= 1980 && d.year < 1990)
+                        rows.push_back(r);
+                }
+                doNotOptimize(rows.data());
+            }
+        });
+
+        add("scan/born-table", [](State& state, Fixture& f)
+        {
+            const ContactTable& table = f.table();
+            state.setItemsPerIteration(f.size());
+            while (state.keepRunning())
+                doNotOptimize(table.bornBetween(Contact::Date{ 1, 1, 1980 }, Contact::Date{ 31, 12, 1989 }));
+        });
+
+        // Output formatting, with the bytes thrown away.
+        add("format/line", [](State& state, Fixture& f)
+        {
+            const std::vector<Contact>& contacts = f.contacts();
+            std::size_t i = 0;
+            while (state.keepRunning())
+                doNotOptimize(formatContactLine(contacts[i++ % contacts.size()]));
+        });
+
+        add("format/record", [](State& state, Fixture& f)
+        {
+            const std::vector<Contact>& contacts = f.contacts();
+            NullBuffer   buffer;
+            std::ostream os(&buffer);
+            ContactWriter out(os);
+            std::size_t i = 0;
+            while (state.keepRunning())
+                out.record(contacts[i++ % contacts.size()]);
+        });
+
+        add("format/card", [](State& state, Fixture& f)
+        {
+            const std::vector<Contact>& contacts = f.contacts();
+            NullBuffer   buffer;
+            std::ostream os(&buffer);
+            ContactWriter out(os);
+            std::size_t i = 0;
+            while (state.keepRunning())
+            {
+                out.card(contacts[i % contacts.size()], i + 1);
+                ++i;
+            }
+        });
+
+        // SharedContactStore readers, alone and next to a writer that keeps
+        // replacing contacts (each replace publishes a new version).
+        auto sharedReads = [](State& state, Fixture& f, bool withWriter)
+        {
+            SharedContactStore& shared = f.shared();
+            const std::vector<const Contact*>& sample = f.sample();
+
+            std::atomic<bool> stop{ false };
+            std::thread writer;
+            if (withWriter)
+            {
+                writer = std::thread([&]
+                {
+                    std::size_t i = 0;
+                    while (!stop.load(std::memory_order_relaxed))
+                    {
+                        const Contact* c = sample[i++ % sample.size()];
+                        shared.replace(c->getemail(), *c);
+                    }
+                });
+            }
+
+            std::size_t i = 0;
+            while (state.keepRunning())
+            {
+                std::shared_ptr<const SharedContactStore::View> view = shared.view();
+                doNotOptimize(view->findByEmail(sample[i++ % sample.size()]->getemail()));
+            }
+
+            stop = true;
+            if (writer.joinable())
+                writer.join();
+        };
+
+        add("shared/read", [=](State& state, Fixture& f) { sharedReads(state, f, false); });
+        add("shared/read-with-writer", [=](State& state, Fixture& f) { sharedReads(state, f, true); });
+
+        return list;
+    }
+
+    std::string humanRate(double perSecond)
+    {
+        const char* units[] = { "", "k", "M", "G" };
+        int unit = 0;
+        while (perSecond >= 1000 && unit < 3)
+        {
+            perSecond /= 1000;
+            ++unit;
+        }
+
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(perSecond < 10 ? 2 : perSecond < 100 ? 1 : 0) << perSecond << units[unit] << "/s";
+        return out.str();
+    }
+
+    void runBenchmark(const Benchmark& b, Fixture& f, double minSeconds)
+    {
+        // Double the iterations until a run is long enough to trust; the
+        // first run also builds whatever the fixture is still missing.
+        for (std::uint64_t iterations = 1;; iterations *= 2)
+        {
+            State state(iterations);
+            b.run(state, f);
+
+            double seconds = std::chrono::duration<double>(state.elapsed()).count();
+            if (seconds >= minSeconds || iterations >= (std::uint64_t(1) << 40))
+            {
+                double nsPerOp = seconds * 1e9 / static_cast<double>(state.iterations());
+                std::cout << std::left << std::setw(28) << b.name << std::right
+                          << std::setw(10) << f.size()
+                          << std::setw(12) << state.iterations()
+                          << std::setw(16) << std::fixed << std::setprecision(1) << nsPerOp
+                          << std::setw(14) << humanRate(static_cast<double>(state.items()) / seconds) << '\n';
+                return;
+            }
+        }
+    }
+
+    bool parseCount(const std::string& text, unsigned long long& value)
+    {
+        std::istringstream in(text);
+        return (in >> value) && in.eof();
+    }
+
+    bool parseSizes(const std::string& text, std::vector<std::size_t>& sizes)
+    {
+        sizes.clear();
+        std::istringstream in(text);
+        std::string item;
+        while (std::getline(in, item, ','))
+        {
+            unsigned long long n = 0;
+            if (!parseCount(item, n) || n == 0)
+                return false;
+            sizes.push_back(static_cast<std::size_t>(n));
+        }
+        return !sizes.empty();
+    }
+
+    void printUsage(std::ostream& os)
+    {
+        os << "Usage: benchmarks [--sizes 10000,1000000] [--filter <substring>] [--min-time <seconds>]\n"
+              "                  [--dir <scratch directory>]\n"
+              "       benchmarks generate <count> <file> [seed]\n";
+    }
+
+    int generate(int argc, char* argv[])
+    {
+        unsigned long long count = 0;
+        unsigned long long seed  = kDefaultDatasetSeed;
+        if (argc < 4 || argc > 5 || !parseCount(argv[2], count) || (argc == 5 && !parseCount(argv[4], seed)))
+        {
+            printUsage(std::cerr);
+            return 1;
+        }
+
+        if (!writeSyntheticContacts(argv[3], static_cast<std::size_t>(count), seed))
+        {
+            std::cerr << "Cannot write " << argv[3] << ".\n";
+            return 1;
+        }
+        std::cerr << argv[3] << ": " << count << " contacts generated.\n";
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && std::string_view(argv[1]) == "generate")
+        return generate(argc, argv);
+
+    std::vector<std::size_t> sizes{ 10000, 1000000 };
+    std::string filter;
+    std::string dir = ".";
+    double      minSeconds = 0.5;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--sizes" && hasValue && parseSizes(argv[i + 1], sizes))
+            ++i;
+        else if (arg == "--filter" && hasValue)
+            filter = argv[++i];
+        else if (arg == "--dir" && hasValue)
+            dir = argv[++i];
+        else if (arg == "--min-time" && hasValue && (std::istringstream(argv[i + 1]) >> minSeconds))
+            ++i;
+        else
+        {
+            printUsage(arg == "--help" ? std::cout : std::cerr);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<Benchmark> list = benchmarks();
+
+    std::cout << std::left << std::setw(28) << "Benchmark" << std::right
+              << std::setw(10) << "Size"
+              << std::setw(12) << "Iterations"
+              << std::setw(16) << "ns/op"
+              << std::setw(14) << "items/s" << '\n'
+              << std::string(80, '-') << '\n';
+
+    for (std::size_t size : sizes)
+    {
+        Fixture fixture(size, dir);
+        for (const Benchmark& b : list)
+        {
+            if (b.name.find(filter) != std::string::npos)
+                runBenchmark(b, fixture, minSeconds);
+        }
+    }
+    return 0;
+}
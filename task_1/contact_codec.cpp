@@ -0,0 +1,104 @@
+#include "contact_codec.h"
+
+#include <charconv>
+
+namespace
+{
+    // Writes value with at least two digits.
+    char* putTwoDigits(char* out, char* end, int value)
+    {
+        if (value >= 0 && value < 10)
+            *out++ = '0';
+        return std::to_chars(out, end, value).ptr;
+    }
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    void skipSpace(std::string_view& text)
+    {
+        while (!text.empty() && isSpace(text.front()))
+            text.remove_prefix(1);
+    }
+
+    // Parses an int at the front of text, after any whitespace and with an
+    // optional '+' or '-', and drops it from text.
+    bool takeNumber(std::string_view& text, int& value)
+    {
+        skipSpace(text);
+        std::string_view digits = text;
+        if (!digits.empty() && digits.front() == '+')
+        {
+            digits.remove_prefix(1);
+            if (!digits.empty() && digits.front() == '-')
+                return false;
+        }
+
+        auto res = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+        if (res.ec != std::errc() || res.ptr == digits.data())
+            return false;
+
+        text.remove_prefix(static_cast<std::size_t>(res.ptr - text.data()));
+        return true;
+    }
+
+    bool takeDot(std::string_view& text)
+    {
+        skipSpace(text);
+        if (text.empty() || text.front() != '.')
+            return false;
+
+        text.remove_prefix(1);
+        return true;
+    }
+}
+
+std::string_view phoneTypeName(Contact::PhoneType type)
+{
+    switch (type)
+    {
+    case Contact::PhoneType::Work:    return "Work";
+    case Contact::PhoneType::Home:    return "Home";
+    case Contact::PhoneType::Service: return "Service";
+    }
+    return "Unknown";
+}
+
+bool parsePhoneType(std::string_view name, Contact::PhoneType& type)
+{
+    if (name == "Work")    { type = Contact::PhoneType::Work;    return true; }
+    if (name == "Home")    { type = Contact::PhoneType::Home;    return true; }
+    if (name == "Service") { type = Contact::PhoneType::Service; return true; }
+    return false;
+}
+
+std::size_t formatDate(char* out, const Contact::Date& date)
+{
+    char* end = out + kMaxDateLength;
+    char* p   = putTwoDigits(out, end, date.day);
+    *p++ = '.';
+    p    = putTwoDigits(p, end, date.month);
+    *p++ = '.';
+    p    = std::to_chars(p, end, date.year).ptr;
+    return static_cast<std::size_t>(p - out);
+}
+
+void appendDate(std::string& out, const Contact::Date& date)
+{
+    char text[kMaxDateLength];
+    out.append(text, formatDate(text, date));
+}
+
+bool parseDate(std::string_view text, Contact::Date& date)
+{
+    // Whatever follows the year is left alone, as it was by the stream parser.
+    Contact::Date d{};
+    if (!takeNumber(text, d.day) || !takeDot(text) || !takeNumber(text, d.month) || !takeDot(text) ||
+        !takeNumber(text, d.year))
+        return false;
+
+    date = d;
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef CONTACT_CODEC_H
+#define CONTACT_CODEC_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "Contact_class.h"
+
+// Text forms of the contact fields that are not plain strings, shared by the
+// file format and the writers. Nothing here allocates: values are written into
+// a caller's char array or appended to a buffer the caller reuses.
+
+// "Work", "Home" or "Service", pointing at static storage.
+std::string_view phoneTypeName (Contact::PhoneType type);
+bool             parsePhoneType(std::string_view name, Contact::PhoneType& type);
+
+// Dates are written "dd.mm.yyyy": day and month with two digits, the year as is.
+constexpr std::size_t kMaxDateLength = 36;
+
+std::size_t formatDate(char* out, const Contact::Date& date);   // writes at most kMaxDateLength chars
+void        appendDate(std::string& out, const Contact::Date& date);
+
+// Reads "d.m.y" with any number of digits per part. It accepts what the former
+// istream parser did, so files that loaded before still load: whitespace before
+// any part, a '+' or '-' sign on each number, and anything after the year.
+// Only the syntax is checked, see Contact::isValidDate for the rest.
+bool        parseDate (std::string_view text, Contact::Date& date);
+
+#endif // CONTACT_CODEC_H
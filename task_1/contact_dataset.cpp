@@ -0,0 +1,310 @@
+#include "contact_dataset.h"
+#include "contact_codec.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+    const char* const kMaleNames[] = {
+        "Alexander", "Sergey", "Dmitry", "Andrey", "Alexey", "Maxim", "Evgeny", "Ivan",
+        "Mikhail", "Artem", "Nikolay", "Vladimir", "Denis", "Pavel", "Roman", "Igor",
+        "Anton", "Oleg", "Kirill", "Viktor", "Yury", "Ilya", "Konstantin", "Vadim",
+        "Egor", "Timur", "Stanislav", "Nikita", "Ruslan", "Vyacheslav", "Gleb", "Leonid",
+        "Boris", "Arseny", "Fedor", "Matvey", "Georgy", "Valentin", "Yaroslav", "Grigory",
+    };
+
+    const char* const kFemaleNames[] = {
+        "Elena", "Olga", "Natalya", "Tatyana", "Irina", "Anna", "Svetlana", "Maria",
+        "Ekaterina", "Yulia", "Anastasia", "Marina", "Daria", "Victoria", "Oksana", "Ksenia",
+        "Alina", "Polina", "Valentina", "Galina", "Lyudmila", "Nadezhda", "Vera", "Larisa",
+        "Sofia", "Alisa", "Kristina", "Evgenia", "Veronika", "Yana", "Elizaveta", "Milana",
+        "Arina", "Diana", "Lidia", "Zoya", "Tamara", "Raisa", "Inna", "Alla",
+    };
+
+    // Masculine forms; the feminine form is derived by feminine().
+    const char* const kSurnames[] = {
+        "Ivanov", "Smirnov", "Kuznetsov", "Popov", "Vasiliev", "Petrov", "Sokolov", "Mikhailov",
+        "Novikov", "Fedorov", "Morozov", "Volkov", "Alekseev", "Lebedev", "Semenov", "Egorov",
+        "Pavlov", "Kozlov", "Stepanov", "Nikolaev", "Orlov", "Andreev", "Makarov", "Nikitin",
+        "Zakharov", "Zaitsev", "Soloviev", "Borisov", "Yakovlev", "Grigoriev", "Romanov", "Vorobiev",
+        "Sergeev", "Kuzmin", "Frolov", "Alexandrov", "Dmitriev", "Korolev", "Gusev", "Kiselev",
+        "Ilyin", "Maximov", "Polyakov", "Sorokin", "Vinogradov", "Kovalev", "Belov", "Medvedev",
+        "Antonov", "Tarasov", "Zhukov", "Baranov", "Filippov", "Komarov", "Davydov", "Belyaev",
+        "Gerasimov", "Bogdanov", "Osipov", "Sidorov", "Matveev", "Titov", "Markov", "Mironov",
+        "Krylov", "Kulikov", "Karpov", "Vlasov", "Melnikov", "Denisov", "Gavrilov", "Tikhonov",
+        "Kazakov", "Afanasiev", "Danilov", "Savelyev", "Timofeev", "Fomin", "Chernov", "Abramov",
+        "Martynov", "Efimov", "Fedotov", "Shcherbakov", "Nazarov", "Kalinin", "Isaev", "Chernyshev",
+        "Bykov", "Maslov", "Rodionov", "Konovalov", "Lazarev", "Voronin", "Klimov", "Filatov",
+        "Ponomarev", "Golubev", "Kudryavtsev", "Prokhorov", "Naumov", "Potapov", "Zhuravlev", "Ovchinnikov",
+        "Trofimov", "Leonov", "Sobolev", "Ermakov", "Kolesnikov", "Goncharov", "Emelyanov", "Nikiforov",
+        "Grachev", "Kotov", "Grishin", "Efremov", "Arkhipov", "Gromov", "Kirillov", "Malyshev",
+        "Panov", "Moiseev", "Rumyantsev", "Akimov", "Kondratiev", "Biryukov", "Gorbunov", "Anisimov",
+        "Eremin", "Tikhomirov", "Galkin", "Lukyanov", "Mikheev", "Skvortsov", "Yudin", "Belousov",
+        "Nesterov", "Simonov", "Prokofiev", "Kharitonov", "Knyazev", "Tsvetkov", "Levin", "Mitrofanov",
+        "Voronov", "Aksenov", "Sofronov", "Maltsev", "Loginov", "Gorshkov", "Savin", "Krasnov",
+        "Mayorov", "Demidov", "Eliseev", "Rybakov", "Safonov", "Plotnikov", "Demin", "Khokhlov",
+        "Kovalenko", "Shevchenko", "Bondarenko", "Tkachenko", "Kravchenko", "Oleynik", "Lysenko", "Rudenko",
+        "Vishnevsky", "Kovalsky", "Zhdanov", "Pestov", "Voloshin", "Lapin", "Shubin", "Rogov",
+    };
+
+    // Father's names as they appear in a patronymic, before "ich" or "na".
+    const char* const kPatronymicStems[] = {
+        "Alexandrov", "Sergeev", "Vladimirov", "Nikolaev", "Ivanov", "Andreev", "Alekseev", "Mikhailov",
+        "Dmitriev", "Viktorov", "Yuriev", "Evgeniev", "Pavlov", "Igorev", "Olegov", "Anatoliev",
+        "Valeriev", "Petrov", "Borisov", "Gennadiev", "Konstantinov", "Romanov", "Leonidov", "Grigoriev",
+    };
+
+    const char* const kCities[] = {
+        "Moscow", "Saint Petersburg", "Novosibirsk", "Yekaterinburg", "Kazan", "Nizhny Novgorod",
+        "Chelyabinsk", "Samara", "Omsk", "Rostov-on-Don", "Ufa", "Krasnoyarsk", "Voronezh", "Perm",
+        "Volgograd", "Krasnodar", "Tyumen", "Saratov", "Tolyatti", "Izhevsk",
+    };
+
+    const char* const kStreets[] = {
+        "Lenina", "Sovetskaya", "Mira", "Molodezhnaya", "Tsentralnaya", "Shkolnaya", "Lesnaya", "Sadovaya",
+        "Naberezhnaya", "Gagarina", "Pushkina", "Kirova", "Oktyabrskaya", "Zelenaya", "Novaya", "Pobedy",
+    };
+
+    const char* const kDomains[] = {
+        "mail.ru", "yandex.ru", "gmail.com", "bk.ru", "inbox.ru", "list.ru", "rambler.ru", "ya.ru",
+    };
+
+    const char* const kAreaCodes[] = {
+        "916", "903", "926", "985", "915", "925", "999", "905", "495", "499",
+        "812", "911", "921", "931", "383", "343", "843", "831", "863", "861",
+    };
+
+    // splitmix64: a fast, well-mixed stream seeded per record.
+    class Random
+    {
+    public:
+        Random(std::uint64_t seed, std::uint64_t index)
+            : state_(seed ^ (index * 0x9E3779B97F4A7C15ULL))
+        {
+        }
+
+        std::uint64_t next()
+        {
+            std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        unsigned below(unsigned n) { return static_cast<unsigned>(next() % n); }
+
+    private:
+        std::uint64_t state_;
+    };
+
+    // Picks index r of a list of n with weight 1 / (r + 1), like name frequencies.
+    class Zipf
+    {
+    public:
+        explicit Zipf(std::size_t n)
+        {
+            double total = 0;
+            for (std::size_t r = 0; r < n; ++r)
+            {
+                total += 1.0 / static_cast<double>(r + 1);
+                cumulative_.push_back(total);
+            }
+            for (double& c : cumulative_)
+                c /= total;
+        }
+
+        std::size_t pick(Random& rng) const
+        {
+            double u = static_cast<double>(rng.next() >> 11) / static_cast<double>(std::uint64_t(1) << 53);
+            auto it = std::upper_bound(cumulative_.begin(), cumulative_.end(), u);
+            return std::min(static_cast<std::size_t>(it - cumulative_.begin()), cumulative_.size() - 1);
+        }
+
+    private:
+        std::vector<double> cumulative_;
+    };
+
+    template <typename T, std::size_t N>
+    const char* pick(const Zipf& zipf, Random& rng, T (&list)[N])
+    {
+        return list[zipf.pick(rng)];
+    }
+
+    struct Record
+    {
+        std::string        name;
+        std::string        surname;
+        std::string        patronymic;
+        std::string        address;
+        std::string        email;
+        Contact::Date      birth{};
+        Contact::PhoneList phones;
+        std::string        phoneText;
+    };
+
+    std::string feminine(std::string surname)
+    {
+        std::size_t n = surname.size();
+        if (n > 3 && surname.compare(n - 3, 3, "sky") == 0)
+            surname.replace(n - 3, 3, "skaya");
+        else if (n > 2 && (surname.compare(n - 2, 2, "ov") == 0 || surname.compare(n - 2, 2, "ev") == 0 ||
+                           surname.compare(n - 2, 2, "in") == 0))
+            surname += 'a';
+        return surname;
+    }
+
+    void appendNumber(std::string& out, std::uint64_t value, int width = 0)
+    {
+        char digits[24];
+        auto res = std::to_chars(digits, digits + sizeof(digits), value);
+        for (int pad = width - static_cast<int>(res.ptr - digits); pad > 0; --pad)
+            out += '0';
+        out.append(digits, static_cast<std::size_t>(res.ptr - digits));
+    }
+
+    void appendLower(std::string& out, const std::string& text)
+    {
+        for (char c : text)
+        {
+            if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+                out += static_cast<char>(c | 0x20);
+        }
+    }
+
+    void generate(std::uint64_t index, std::uint64_t seed, Record& r)
+    {
+        static const Zipf maleNames(std::size(kMaleNames));
+        static const Zipf femaleNames(std::size(kFemaleNames));
+        static const Zipf surnames(std::size(kSurnames));
+        static const Zipf stems(std::size(kPatronymicStems));
+        static const Zipf cities(std::size(kCities));
+        static const Zipf streets(std::size(kStreets));
+        static const Zipf domains(std::size(kDomains));
+        static const Zipf areaCodes(std::size(kAreaCodes));
+
+        Random rng(seed, index);
+        bool female = rng.below(2) == 1;
+
+        r.name    = female ? pick(femaleNames, rng, kFemaleNames) : pick(maleNames, rng, kMaleNames);
+        r.surname = pick(surnames, rng, kSurnames);
+        if (female)
+            r.surname = feminine(std::move(r.surname));
+
+        // One in ten has no patronymic, as for foreign names.
+        r.patronymic.clear();
+        if (rng.below(10) != 0)
+            r.patronymic.assign(pick(stems, rng, kPatronymicStems)).append(female ? "na" : "ich");
+
+        r.address.assign(pick(cities, rng, kCities)).append(", ul. ").append(pick(streets, rng, kStreets));
+        r.address += ", d. ";
+        appendNumber(r.address, 1 + rng.below(150));
+        r.address += ", kv. ";
+        appendNumber(r.address, 1 + rng.below(300));
+
+        static const int kDaysInMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        r.birth.year  = 1940 + static_cast<int>(rng.below(69));
+        r.birth.month = 1 + static_cast<int>(rng.below(12));
+        r.birth.day   = 1 + static_cast<int>(rng.below(static_cast<unsigned>(kDaysInMonth[r.birth.month - 1])));
+
+        // The record index keeps e-mails unique whatever the names are.
+        r.email.clear();
+        appendLower(r.email, r.name);
+        r.email += '.';
+        appendLower(r.email, r.surname);
+        appendNumber(r.email, index);
+        r.email += '@';
+        r.email += pick(domains, rng, kDomains);
+
+        static const char* const kTypes[] = { "Work", "Home", "Service" };
+        r.phones.clear();
+        r.phoneText.clear();
+        unsigned count = 1 + rng.below(3);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            std::string number = rng.below(2) ? "+7" : "8";
+            const char* area = pick(areaCodes, rng, kAreaCodes);
+            unsigned    rest = rng.below(10000000);
+
+            std::string digits;
+            appendNumber(digits, rest, 7);
+            switch (rng.below(3))
+            {
+            case 0:
+                number.append(area).append(digits);
+                break;
+            case 1:
+                number.append("(").append(area).append(")").append(digits);
+                break;
+            default:
+                number.append("(").append(area).append(")").append(digits, 0, 3);
+                number.append("-").append(digits, 3, 2).append("-").append(digits, 5, 2);
+                break;
+            }
+
+            Contact::PhoneType type = static_cast<Contact::PhoneType>(i);
+            r.phones.add(type, number);
+            if (i > 0)
+                r.phoneText += ',';
+            r.phoneText.append(kTypes[i]).append(":").append(number);
+        }
+    }
+
+    void appendRecord(std::string& out, const Record& r)
+    {
+        out.append(r.name) += '|';
+        out.append(r.surname) += '|';
+        out.append(r.patronymic) += '|';
+        out.append(r.address) += '|';
+        appendDate(out, r.birth);
+        out += '|';
+        out.append(r.email) += '|';
+        out.append(r.phoneText);
+    }
+}
+
+void appendSyntheticRecord(std::string& out, std::uint64_t index, std::uint64_t seed)
+{
+    Record r;
+    generate(index, seed, r);
+    appendRecord(out, r);
+}
+
+bool writeSyntheticContacts(const std::string& filename, std::size_t count, std::uint64_t seed)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    Record r;
+    std::string buffer;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        generate(i, seed, r);
+        appendRecord(buffer, r);
+        buffer += '\n';
+        if (buffer.size() >= (1 << 16))
+        {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return static_cast<bool>(out);
+}
+
+std::vector<Contact> syntheticContacts(std::size_t count, std::uint64_t seed)
+{
+    std::vector<Contact> contacts;
+    contacts.reserve(count);
+
+    Record r;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        generate(i, seed, r);
+        contacts.emplace_back(r.name, r.surname, r.patronymic, r.email, r.address, r.birth, r.phones);
+    }
+    return contacts;
+}
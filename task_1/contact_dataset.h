@@ -0,0 +1,29 @@
+#ifndef CONTACT_DATASET_H
+#define CONTACT_DATASET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Contact_class.h"
+
+// Deterministic synthetic contacts for benchmarks. Record i depends only on
+// (seed, i), so any size is a prefix of every larger one and files are
+// identical on every platform. Names, surnames and patronymics follow a
+// Zipf-like distribution over common Russian names (transliterated), surnames
+// take the feminine form for women, e-mails are unique, and phones mix every
+// notation the validator accepts.
+
+const std::uint64_t kDefaultDatasetSeed = 20240901;
+
+// Appends record i as a contacts.txt line, without the newline.
+void appendSyntheticRecord(std::string& out, std::uint64_t index, std::uint64_t seed = kDefaultDatasetSeed);
+
+// Writes count records to filename in large chunks. False if the file cannot be written.
+bool writeSyntheticContacts(const std::string& filename, std::size_t count,
+                            std::uint64_t seed = kDefaultDatasetSeed);
+
+// The same records as Contact objects.
+std::vector<Contact> syntheticContacts(std::size_t count, std::uint64_t seed = kDefaultDatasetSeed);
+
+#endif // CONTACT_DATASET_H
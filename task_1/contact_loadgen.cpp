@@ -0,0 +1,233 @@
+// Load generator for the lookup server (contact_server.h). Opens several
+// connections, keeps a pipeline of GET requests in flight on each and reports
+// throughput and latency percentiles. Linux only, like the server.
+//
+//   loadgen --socket <path> --keys <contacts file>
+//           [--connections 4] [--depth 16] [--seconds 5]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        std::string socketPath;
+        std::string keysFile;
+        unsigned    connections = 4;
+        unsigned    depth       = 16;
+        unsigned    seconds     = 5;
+    };
+
+    // E-mail is the sixth field of a contacts.txt record.
+    std::vector<std::string> readKeys(const std::string& filename)
+    {
+        std::vector<std::string> keys;
+        std::ifstream in(filename);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::size_t pos = 0;
+            for (int i = 0; i < 5 && pos != std::string::npos; ++i)
+            {
+                pos = line.find('|', pos);
+                if (pos != std::string::npos)
+                    ++pos;
+            }
+            if (pos == std::string::npos)
+                continue;
+
+            std::size_t end = line.find('|', pos);
+            if (end != std::string::npos && end > pos)
+                keys.push_back(line.substr(pos, end - pos));
+        }
+        return keys;
+    }
+
+    int connectTo(const std::string& path)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            return -1;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    bool sendAll(int fd, const std::string& data)
+    {
+        std::size_t sent = 0;
+        while (sent < data.size())
+        {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                return false;
+            sent += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    // Sends batches of depth requests and times every reply from the moment its batch went out.
+    void runConnection(const Options& opt, const std::vector<std::string>& keys, unsigned seed,
+                       Clock::time_point deadline, std::vector<std::uint32_t>& latencies,
+                       std::atomic<std::uint64_t>& misses, std::atomic<bool>& failed)
+    {
+        int fd = connectTo(opt.socketPath);
+        if (fd < 0)
+        {
+            failed = true;
+            return;
+        }
+
+        std::uint64_t next = seed;
+        std::string batch;
+        char chunk[64 * 1024];
+
+        while (Clock::now() < deadline)
+        {
+            batch.clear();
+            for (unsigned i = 0; i < opt.depth; ++i)
+            {
+                next = next * 6364136223846793005ULL + 1442695040888963407ULL;
+                batch.append("GET ").append(keys[(next >> 33) % keys.size()]) += '\n';
+            }
+
+            Clock::time_point start = Clock::now();
+            if (!sendAll(fd, batch))
+            {
+                failed = true;
+                break;
+            }
+
+            unsigned pending = opt.depth;
+            bool lineStart = true;
+            while (pending > 0)
+            {
+                ssize_t n = ::read(fd, chunk, sizeof(chunk));
+                if (n <= 0)
+                {
+                    failed = true;
+                    ::close(fd);
+                    return;
+                }
+
+                Clock::time_point now = Clock::now();
+                auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
+                for (ssize_t i = 0; i < n; ++i)
+                {
+                    if (lineStart && chunk[i] == 'N')
+                        ++misses;
+                    lineStart = chunk[i] == '\n';
+                    if (lineStart)
+                    {
+                        latencies.push_back(static_cast<std::uint32_t>(micros));
+                        --pending;
+                    }
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    bool parseOptions(int argc, char** argv, Options& opt)
+    {
+        for (int i = 1; i + 1 < argc; i += 2)
+        {
+            std::string name  = argv[i];
+            std::string value = argv[i + 1];
+            std::istringstream number(value);
+
+            if (name == "--socket")
+                opt.socketPath = value;
+            else if (name == "--keys")
+                opt.keysFile = value;
+            else if (name == "--connections")
+                number >> opt.connections;
+            else if (name == "--depth")
+                number >> opt.depth;
+            else if (name == "--seconds")
+                number >> opt.seconds;
+            else
+                return false;
+        }
+        return argc % 2 == 1 && !opt.socketPath.empty() && !opt.keysFile.empty() &&
+               opt.connections > 0 && opt.depth > 0 && opt.seconds > 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parseOptions(argc, argv, opt))
+    {
+        std::cerr << "Usage: loadgen --socket <path> --keys <contacts file>\n"
+                     "               [--connections 4] [--depth 16] [--seconds 5]\n";
+        return 1;
+    }
+
+    std::vector<std::string> keys = readKeys(opt.keysFile);
+    if (keys.empty())
+    {
+        std::cerr << "No e-mails found in " << opt.keysFile << ".\n";
+        return 1;
+    }
+
+    std::vector<std::vector<std::uint32_t>> latencies(opt.connections);
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<bool> failed{false};
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::seconds(opt.seconds);
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < opt.connections; ++i)
+    {
+        threads.emplace_back(runConnection, std::cref(opt), std::cref(keys), i + 1, deadline,
+                             std::ref(latencies[i]), std::ref(misses), std::ref(failed));
+    }
+    for (std::thread& t : threads)
+        t.join();
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<std::uint32_t> all;
+    for (const auto& l : latencies)
+        all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+
+    if (all.empty())
+    {
+        std::cerr << "No replies received" << (failed ? ": cannot talk to the server.\n" : ".\n");
+        return 1;
+    }
+
+    auto percentile = [&](double p) { return all[static_cast<std::size_t>(p * (all.size() - 1))]; };
+
+    std::cout << "requests:   " << all.size() << " (" << misses << " not found)\n"
+              << "throughput: " << static_cast<std::uint64_t>(all.size() / elapsed) << " req/s\n"
+              << "latency us: p50 " << percentile(0.50) << ", p99 " << percentile(0.99)
+              << ", max " << all.back() << '\n';
+    return failed ? 1 : 0;
+}
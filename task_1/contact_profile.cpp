@@ -0,0 +1,193 @@
+#include "contact_profile.h"
+
+#ifdef CONTACTS_PROFILE
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    thread_local std::uint64_t      threadAllocs = 0;
+    std::atomic<std::uint64_t>      totalAllocs{0};
+    std::atomic<std::uint64_t>      totalBytes{0};
+
+    std::mutex& registryMutex()
+    {
+        static std::mutex* m = new std::mutex;
+        return *m;
+    }
+
+    // The registry and its points are never freed, so the report at exit can still read them.
+    std::vector<profile::Point*>& registry()
+    {
+        static std::vector<profile::Point*>* points = new std::vector<profile::Point*>;
+        return *points;
+    }
+
+    void* allocate(std::size_t size)
+    {
+        ++threadAllocs;
+        totalAllocs.fetch_add(1, std::memory_order_relaxed);
+        totalBytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (void* p = std::malloc(size ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    std::string_view microseconds(std::uint64_t ns, char* buffer, std::size_t size)
+    {
+        int n = std::snprintf(buffer, size, "%.1f", static_cast<double>(ns) / 1000.0);
+        return { buffer, static_cast<std::size_t>(std::max(n, 0)) };
+    }
+
+    struct ExitReport
+    {
+        ~ExitReport()
+        {
+            if (!registry().empty())
+                dumpProfile(std::cerr);
+        }
+    } exitReport;
+}
+
+// Counts every allocation of the process; frees need no bookkeeping.
+void* operator new  (std::size_t size)                         { return allocate(size); }
+void* operator new[](std::size_t size)                         { return allocate(size); }
+void  operator delete  (void* p) noexcept                      { std::free(p); }
+void  operator delete[](void* p) noexcept                      { std::free(p); }
+void  operator delete  (void* p, std::size_t) noexcept         { std::free(p); }
+void  operator delete[](void* p, std::size_t) noexcept         { std::free(p); }
+
+namespace profile
+{
+    std::size_t Histogram::bucketOf(std::uint64_t value) noexcept
+    {
+        const std::uint64_t sub = std::uint64_t(1) << kSubBits;
+        if (value < sub)
+            return static_cast<std::size_t>(value);
+
+        unsigned msb   = 63u - static_cast<unsigned>(__builtin_clzll(value));
+        unsigned shift = msb - kSubBits;
+        return (static_cast<std::size_t>(shift + 1) << kSubBits) + static_cast<std::size_t>((value >> shift) - sub);
+    }
+
+    std::uint64_t Histogram::upperBound(std::size_t bucket) noexcept
+    {
+        const std::uint64_t sub = std::uint64_t(1) << kSubBits;
+        if (bucket < sub)
+            return bucket;
+
+        unsigned shift = static_cast<unsigned>(bucket >> kSubBits) - 1;
+        return ((sub + (bucket & (sub - 1)) + 1) << shift) - 1;
+    }
+
+    void Histogram::record(std::uint64_t value) noexcept
+    {
+        buckets_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+
+        std::uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    std::uint64_t Histogram::quantile(double q) const noexcept
+    {
+        std::uint64_t n = count();
+        if (n == 0)
+            return 0;
+
+        // Rank of the quantile, 1-based; the bucket reaching it holds the value.
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(n - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t b = 0; b < kBuckets; ++b)
+        {
+            seen += buckets_[b].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(upperBound(b), max());
+        }
+        return max();
+    }
+
+    Point& point(const char* name)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (Point* p : registry())
+        {
+            if (std::strcmp(p->name, name) == 0)
+                return *p;
+        }
+
+        Point* p = new Point;
+        p->name = name;
+        registry().push_back(p);
+        return *p;
+    }
+
+    std::uint64_t threadAllocations() noexcept
+    {
+        return threadAllocs;
+    }
+}
+
+void dumpProfile(std::ostream& os)
+{
+    std::vector<profile::Point*> points;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        points = registry();
+    }
+    std::sort(points.begin(), points.end(),
+              [](const profile::Point* a, const profile::Point* b) { return std::strcmp(a->name, b->name) < 0; });
+
+    os << "===== PROFILE =====\n"
+       << std::left << std::setw(28) << "scope" << std::right
+       << std::setw(10) << "count" << std::setw(12) << "p50 us" << std::setw(12) << "p99 us"
+       << std::setw(12) << "max us" << std::setw(12) << "allocs/call" << '\n';
+
+    char a[32], b[32], c[32];
+    for (const profile::Point* p : points)
+    {
+        const profile::Histogram& h = p->nanoseconds;
+        if (h.count() == 0)
+            continue;
+
+        double allocs = static_cast<double>(p->allocations.load(std::memory_order_relaxed)) / static_cast<double>(h.count());
+        os << std::left << std::setw(28) << p->name << std::right
+           << std::setw(10) << h.count()
+           << std::setw(12) << microseconds(h.quantile(0.5), a, sizeof(a))
+           << std::setw(12) << microseconds(h.quantile(0.99), b, sizeof(b))
+           << std::setw(12) << microseconds(h.max(), c, sizeof(c))
+           << std::setw(12) << std::fixed << std::setprecision(1) << allocs << '\n';
+    }
+
+    for (const profile::Point* p : points)
+    {
+        std::uint64_t total = p->total.load(std::memory_order_relaxed);
+        if (total != 0)
+            os << std::left << std::setw(28) << p->name << std::right << std::setw(10) << total << '\n';
+    }
+
+    os << "heap: " << totalAllocs.load(std::memory_order_relaxed) << " allocations, "
+       << totalBytes.load(std::memory_order_relaxed) << " bytes\n";
+    os.flush();
+}
+
+#else
+
+void dumpProfile(std::ostream& os)
+{
+    os << "Profiling is not compiled in (build with CONFIG += contacts_profile).\n";
+}
+
+#endif // CONTACTS_PROFILE
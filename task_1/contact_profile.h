@@ -0,0 +1,129 @@
+#ifndef CONTACT_PROFILE_H
+#define CONTACT_PROFILE_H
+
+#include <ostream>
+
+// Hot-path instrumentation, compiled in only when CONTACTS_PROFILE is defined
+// (qmake: CONFIG += contacts_profile). Otherwise the macros below expand to nothing and
+// the build is unchanged.
+//
+//   PROFILE_SCOPE("storage.load");      time the rest of the enclosing block
+//   PROFILE_COUNT("storage.lines", n);  add n to a counter
+//
+// Names must be string literals. Each timed scope keeps a log-linear histogram
+// (16 sub-buckets per power of two, so percentiles are within about 6%) of its
+// wall time and counts the heap allocations made inside it, children included.
+// Recording is a few relaxed atomic adds, so scopes may be hit from any thread.
+//
+// The report (count, p50/p99/max, allocations per call) is written to stderr at
+// exit, and on demand through dumpProfile().
+
+#ifdef CONTACTS_PROFILE
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace profile
+{
+    class Histogram
+    {
+    public:
+        static constexpr unsigned    kSubBits = 4;
+        static constexpr std::size_t kBuckets = (64 - kSubBits + 1) << kSubBits;
+
+        void record(std::uint64_t value) noexcept;
+
+        std::uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+        std::uint64_t max()   const noexcept { return max_.load(std::memory_order_relaxed); }
+
+        // Upper bound of the bucket holding the q-th quantile, 0 <= q <= 1.
+        std::uint64_t quantile(double q) const noexcept;
+
+    private:
+        static std::size_t   bucketOf  (std::uint64_t value) noexcept;
+        static std::uint64_t upperBound(std::size_t bucket) noexcept;
+
+        std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};
+        std::atomic<std::uint64_t>                       count_{0};
+        std::atomic<std::uint64_t>                       max_{0};
+    };
+
+    // One named scope or counter. Points are created on first use and live
+    // until exit.
+    struct Point
+    {
+        const char*                name;
+        Histogram                  nanoseconds;
+        std::atomic<std::uint64_t> allocations{0};
+        std::atomic<std::uint64_t> total{0};   // counters only
+    };
+
+    Point& point(const char* name);
+
+    // Heap allocations made so far by the calling thread.
+    std::uint64_t threadAllocations() noexcept;
+
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Point& p) noexcept
+            : point_(p), allocations_(threadAllocations()), start_(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            point_.nanoseconds.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            point_.allocations.fetch_add(threadAllocations() - allocations_, std::memory_order_relaxed);
+        }
+
+        ScopedTimer(const ScopedTimer&)            = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Point&                                point_;
+        std::uint64_t                         allocations_;
+        std::chrono::steady_clock::time_point start_;
+    };
+}
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+
+#define PROFILE_SCOPE(name)                                                                  \
+    static ::profile::Point& PROFILE_CONCAT(profilePoint_, __LINE__) = ::profile::point(name); \
+    ::profile::ScopedTimer PROFILE_CONCAT(profileTimer_, __LINE__)(PROFILE_CONCAT(profilePoint_, __LINE__))
+
+#define PROFILE_COUNT(name, n)                                                               \
+    do {                                                                                     \
+        static ::profile::Point& profilePoint_ = ::profile::point(name);                     \
+        profilePoint_.total.fetch_add(static_cast<std::uint64_t>(n), std::memory_order_relaxed); \
+    } while (false)
+
+#else
+
+#define PROFILE_SCOPE(name)    ((void)0)
+#define PROFILE_COUNT(name, n) ((void)0)
+
+#endif // CONTACTS_PROFILE
+
+// True when built with CONTACTS_PROFILE.
+constexpr bool profilingEnabled()
+{
+#ifdef CONTACTS_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Writes the report of every scope and counter hit so far. Without
+// CONTACTS_PROFILE it only says that profiling is off.
+void dumpProfile(std::ostream& os);
+
+#endif // CONTACT_PROFILE_H
@@ -0,0 +1,620 @@
+#include "contact_server.h"
+#include "contact_profile.h"
+
+#include <iostream>
+
+#ifdef __linux__
+
+#include "contact_shared_store.h"
+#include "contact_storage.h"
+#include "phone_index.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    // Reading from a client pauses while this much of its input waits for
+    // workers; a client sending this much without a newline is dropped.
+    const std::size_t kMaxPendingInput  = 1 << 20;
+
+    // No new batch is started while this much reply data waits for the client.
+    const std::size_t kMaxPendingOutput = 1 << 20;
+
+    const std::uint64_t kListenId = 0;
+    const std::uint64_t kWakeId   = 1;
+    const std::uint64_t kSignalId = 2;
+
+    class Server
+    {
+    public:
+        Server(ContactStore& store, unsigned workers)
+            : store_(store), shared_(store.contacts()), workerCount_(workers)
+        {
+        }
+
+        int run(const std::string& socketPath);
+
+    private:
+        struct Connection
+        {
+            int           fd = -1;
+            std::string   in;
+            std::string   out;
+            bool          busy   = false;
+            bool          eof    = false;
+            std::uint32_t events = EPOLLIN;
+        };
+
+        // A run of complete request lines from one connection, and the replies to it.
+        struct Batch
+        {
+            std::uint64_t id = 0;
+            std::string   text;
+        };
+
+        bool setUp(const std::string& socketPath);
+        void tearDown(const std::string& socketPath);
+
+        void acceptClients();
+        void readClient (std::uint64_t id);
+        void writeClient(std::uint64_t id);
+        void dispatch   (std::uint64_t id);
+        void collectReplies();
+        void closeClient(std::uint64_t id);
+        void watch      (Connection& c, std::uint64_t id);
+
+        void workerLoop();
+        void handle(std::string_view request, std::string& reply);
+
+        ContactStore&      store_;
+        std::mutex         storeMutex_;
+        SharedContactStore shared_;
+
+        unsigned                 workerCount_;
+        std::vector<std::thread> workers_;
+
+        std::mutex              jobMutex_;
+        std::condition_variable jobReady_;
+        std::deque<Batch>       jobs_;
+        bool                    stopping_ = false;
+
+        std::mutex        replyMutex_;
+        std::deque<Batch> replies_;
+
+        int epoll_    = -1;
+        int listener_ = -1;
+        int wake_     = -1;
+        int signals_  = -1;
+        bool bound_   = false;
+
+        sigset_t oldMask_{};           // the caller's mask, restored by tearDown()
+        bool     maskSaved_ = false;
+
+        std::uint64_t nextId_ = kSignalId + 1;
+        std::unordered_map<std::uint64_t, Connection> clients_;
+    };
+
+    std::string_view stripCommand(std::string_view& request)
+    {
+        std::size_t space = request.find(' ');
+        std::string_view command = request.substr(0, space);
+        request = space == std::string_view::npos ? std::string_view() : request.substr(space + 1);
+        return command;
+    }
+
+    // Only a leftover socket is removed; any other file at the path makes bind() fail.
+    void removeStaleSocket(const std::string& path)
+    {
+        struct stat st;
+        if (::lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+            ::unlink(path.c_str());
+    }
+}
+
+int Server::run(const std::string& socketPath)
+{
+    if (!setUp(socketPath))
+    {
+        tearDown(socketPath);
+        return 1;
+    }
+
+    std::cerr << "Serving " << shared_.view()->size() << " contacts on " << socketPath
+              << " with " << workers_.size() << " workers.\n";
+
+    epoll_event events[64];
+    bool running = true;
+    while (running)
+    {
+        int n = epoll_wait(epoll_, events, 64, -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            std::uint64_t id = events[i].data.u64;
+            if (id == kListenId)
+                acceptClients();
+            else if (id == kWakeId)
+                collectReplies();
+            else if (id == kSignalId)
+                running = false;
+            else
+            {
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    readClient(id);
+                if (events[i].events & EPOLLOUT)
+                    writeClient(id);
+            }
+        }
+    }
+
+    tearDown(socketPath);
+    std::cerr << "Server stopped.\n";
+    return 0;
+}
+
+bool Server::setUp(const std::string& socketPath)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path))
+    {
+        std::cerr << "Socket path is too long.\n";
+        return false;
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // Workers start with SIGINT and SIGTERM blocked too, so only the signalfd sees them.
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, &oldMask_);
+    maskSaved_ = true;
+
+    epoll_    = epoll_create1(EPOLL_CLOEXEC);
+    wake_     = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    signals_  = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    listener_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (epoll_ < 0 || wake_ < 0 || signals_ < 0 || listener_ < 0)
+    {
+        std::cerr << "Cannot set up the event loop: " << std::strerror(errno) << ".\n";
+        return false;
+    }
+
+    removeStaleSocket(socketPath);
+    if (bind(listener_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << ".\n";
+        return false;
+    }
+    bound_ = true;
+
+    if (listen(listener_, SOMAXCONN) < 0)
+    {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << ".\n";
+        return false;
+    }
+
+    const std::pair<int, std::uint64_t> fixed[] = { {listener_, kListenId}, {wake_, kWakeId}, {signals_, kSignalId} };
+    for (const auto& f : fixed)
+    {
+        epoll_event ev{};
+        ev.events   = EPOLLIN;
+        ev.data.u64 = f.second;
+        epoll_ctl(epoll_, EPOLL_CTL_ADD, f.first, &ev);
+    }
+
+    unsigned count = workerCount_ ? workerCount_ : std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < count; ++i)
+        workers_.emplace_back(&Server::workerLoop, this);
+    return true;
+}
+
+void Server::tearDown(const std::string& socketPath)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        stopping_ = true;
+    }
+    jobReady_.notify_all();
+    for (std::thread& t : workers_)
+        t.join();
+    workers_.clear();
+
+    for (auto& entry : clients_)
+        ::close(entry.second.fd);
+    clients_.clear();
+
+    // A signal that stopped the loop is still pending; take it off the queue
+    // before unblocking, or it would kill the process on the way out.
+    if (signals_ >= 0)
+    {
+        signalfd_siginfo info;
+        while (::read(signals_, &info, sizeof(info)) == static_cast<ssize_t>(sizeof(info)))
+        {
+        }
+    }
+    if (maskSaved_)
+        pthread_sigmask(SIG_SETMASK, &oldMask_, nullptr);
+    maskSaved_ = false;
+
+    for (int fd : { listener_, wake_, signals_, epoll_ })
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+    if (bound_)
+        ::unlink(socketPath.c_str());
+    bound_ = false;
+    listener_ = wake_ = signals_ = epoll_ = -1;
+}
+
+void Server::acceptClients()
+{
+    while (true)
+    {
+        int fd = accept4(listener_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        std::uint64_t id = nextId_++;
+        Connection& c = clients_[id];
+        c.fd = fd;
+
+        epoll_event ev{};
+        ev.events   = EPOLLIN;
+        ev.data.u64 = id;
+        epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void Server::readClient(std::uint64_t id)
+{
+    auto it = clients_.find(id);
+    if (it == clients_.end())
+        return;
+    Connection& c = it->second;
+
+    // Reads stop at the cap; the rest waits in the socket until dispatch() has
+    // consumed some lines and watch() asks for EPOLLIN again.
+    char chunk[16 * 1024];
+    while (c.in.size() < kMaxPendingInput)
+    {
+        std::size_t room = std::min(sizeof(chunk), kMaxPendingInput - c.in.size());
+        ssize_t got = ::read(c.fd, chunk, room);
+        if (got > 0)
+        {
+            c.in.append(chunk, static_cast<std::size_t>(got));
+            continue;
+        }
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+            c.eof = true;
+        break;
+    }
+
+    if (c.in.size() >= kMaxPendingInput && c.in.find('\n') == std::string::npos)
+    {
+        closeClient(id);
+        return;
+    }
+    dispatch(id);
+
+    it = clients_.find(id);
+    if (it != clients_.end())
+        watch(it->second, id);
+}
+
+void Server::writeClient(std::uint64_t id)
+{
+    auto it = clients_.find(id);
+    if (it == clients_.end())
+        return;
+    Connection& c = it->second;
+
+    std::size_t sent = 0;
+    while (sent < c.out.size())
+    {
+        ssize_t n = ::send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+        if (n > 0)
+            sent += static_cast<std::size_t>(n);
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else
+        {
+            closeClient(id);
+            return;
+        }
+    }
+    c.out.erase(0, sent);
+
+    dispatch(id);
+
+    it = clients_.find(id);
+    if (it != clients_.end())
+        watch(it->second, id);
+}
+
+void Server::dispatch(std::uint64_t id)
+{
+    auto it = clients_.find(id);
+    if (it == clients_.end())
+        return;
+    Connection& c = it->second;
+
+    if (!c.busy && c.out.size() < kMaxPendingOutput)
+    {
+        std::size_t end = c.in.rfind('\n');
+        if (end != std::string::npos)
+        {
+            Batch job;
+            job.id = id;
+            if (end + 1 == c.in.size())
+                job.text.swap(c.in);
+            else
+            {
+                job.text.assign(c.in, 0, end + 1);
+                c.in.erase(0, end + 1);
+            }
+
+            c.busy = true;
+            {
+                std::lock_guard<std::mutex> lock(jobMutex_);
+                jobs_.push_back(std::move(job));
+            }
+            jobReady_.notify_one();
+        }
+    }
+
+    // A client that hung up is closed once everything it asked for has been answered.
+    if (c.eof && !c.busy && c.out.empty())
+        closeClient(id);
+}
+
+void Server::collectReplies()
+{
+    std::uint64_t count;
+    while (::read(wake_, &count, sizeof(count)) > 0)
+    {
+    }
+
+    std::deque<Batch> done;
+    {
+        std::lock_guard<std::mutex> lock(replyMutex_);
+        done.swap(replies_);
+    }
+
+    for (Batch& b : done)
+    {
+        auto it = clients_.find(b.id);
+        if (it == clients_.end())
+            continue;
+
+        Connection& c = it->second;
+        c.busy = false;
+        if (c.out.empty())
+            c.out.swap(b.text);
+        else
+            c.out += b.text;
+        writeClient(b.id);
+    }
+}
+
+void Server::closeClient(std::uint64_t id)
+{
+    auto it = clients_.find(id);
+    if (it == clients_.end())
+        return;
+
+    epoll_ctl(epoll_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    ::close(it->second.fd);
+    clients_.erase(it);
+}
+
+void Server::watch(Connection& c, std::uint64_t id)
+{
+    std::uint32_t events = 0;
+    if (!c.eof && c.in.size() < kMaxPendingInput)
+        events |= EPOLLIN;
+    if (!c.out.empty())
+        events |= EPOLLOUT;
+
+    if (c.events == events)
+        return;
+
+    epoll_event ev{};
+    ev.events   = events;
+    ev.data.u64 = id;
+    epoll_ctl(epoll_, EPOLL_CTL_MOD, c.fd, &ev);
+    c.events = events;
+}
+
+void Server::workerLoop()
+{
+    while (true)
+    {
+        Batch batch;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex_);
+            jobReady_.wait(lock, [&] { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty())
+                return;
+
+            batch = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        Batch reply;
+        reply.id = batch.id;
+        std::string_view text = batch.text;
+        while (!text.empty())
+        {
+            std::size_t end = text.find('\n');
+            std::string_view request = text.substr(0, end);
+            text.remove_prefix(end + 1);
+
+            if (!request.empty() && request.back() == '\r')
+                request.remove_suffix(1);
+            handle(request, reply.text);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(replyMutex_);
+            replies_.push_back(std::move(reply));
+        }
+        std::uint64_t one = 1;
+        ssize_t ignored = ::write(wake_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void Server::handle(std::string_view request, std::string& reply)
+{
+    PROFILE_SCOPE("server.request");
+    std::string_view arg = request;
+    std::string_view command = stripCommand(arg);
+
+    if (command == "GET")
+    {
+        std::shared_ptr<const SharedContactStore::View> view = shared_.view();
+        SharedContactStore::Handle h = view->findByEmail(arg);
+        if (h == SharedContactStore::npos)
+            reply += "NOTFOUND\n";
+        else
+        {
+            reply += "OK ";
+            appendContactLine(reply, view->at(h));
+            reply += '\n';
+        }
+    }
+    else if (command == "PHONE")
+    {
+        std::uint64_t key;
+        if (!PhoneIndex::key(arg, key))
+        {
+            reply += "ERR invalid number\n";
+            return;
+        }
+
+        std::shared_ptr<const SharedContactStore::View> view = shared_.view();
+        SharedContactStore::Handle h = view->findByPhone(key);
+        if (h == SharedContactStore::npos)
+            reply += "NOTFOUND\n";
+        else
+        {
+            reply += "OK ";
+            appendContactLine(reply, view->at(h));
+            reply += '\n';
+        }
+    }
+    else if (command == "ADD")
+    {
+        std::optional<Contact> c = parseContactLine(arg);
+        if (!c)
+        {
+            reply += "ERR invalid record\n";
+            return;
+        }
+
+        // Readers only see the contact once it is on disk; a failed commit is
+        // undone in the store, so both copies keep the same contacts.
+        std::lock_guard<std::mutex> lock(storeMutex_);
+        std::string email(c->getemail());
+        if (store_.findByEmail(email) != ContactStore::npos)
+            reply += "ERR e-mail already exists\n";
+        else if (!store_.add(*c))
+            reply += "ERR cannot save\n";
+        else if (!store_.commit())
+        {
+            store_.remove(store_.findByEmail(email));
+            reply += "ERR cannot save\n";
+        }
+        else
+        {
+            shared_.add(*c);
+            reply += "OK\n";
+        }
+    }
+    else if (command == "DEL")
+    {
+        std::lock_guard<std::mutex> lock(storeMutex_);
+        ContactStore::Handle h = store_.findByEmail(arg);
+        if (h == ContactStore::npos)
+            reply += "NOTFOUND\n";
+        else
+        {
+            Contact removed = store_.at(h);
+            if (!store_.remove(h))
+                reply += "ERR cannot save\n";
+            else if (!store_.commit())
+            {
+                store_.add(std::move(removed));
+                reply += "ERR cannot save\n";
+            }
+            else
+            {
+                shared_.remove(arg);
+                reply += "OK\n";
+            }
+        }
+    }
+    else if (command == "COUNT" && arg.empty())
+    {
+        char digits[24];
+        auto res = std::to_chars(digits, digits + sizeof(digits), shared_.view()->size());
+        reply += "OK ";
+        reply.append(digits, static_cast<std::size_t>(res.ptr - digits)) += '\n';
+    }
+    else
+    {
+        reply += "ERR unknown request\n";
+    }
+}
+
+int runServer(ContactStore& store, const std::string& socketPath, unsigned workers)
+{
+    Server server(store, workers);
+    return server.run(socketPath);
+}
+
+#else
+
+int runServer(ContactStore&, const std::string&, unsigned)
+{
+    std::cerr << "Server mode is only available on Linux.\n";
+    return 1;
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef CONTACT_SERVER_H
+#define CONTACT_SERVER_H
+
+#include <string>
+#include "contact_store.h"
+
+// Lookup service over a UNIX domain socket (Linux only). One thread runs an
+// epoll loop over the listening socket and all clients and hands every batch
+// of complete request lines to a pool of workers. Each connection has at most
+// one batch in flight, so replies come back in request order and clients may
+// pipeline as deep as they like.
+//
+// One request per line, exactly one reply line per request:
+//
+//   GET <email>      OK <record>  or  NOTFOUND
+//   PHONE <number>   OK <record>  or  NOTFOUND  (caller ID, any notation; first match)
+//   ADD <record>     OK           or  ERR <reason>
+//   DEL <email>      OK           or  NOTFOUND
+//   COUNT            OK <number of contacts>
+//
+// where <record> is a contacts.txt line. Lookups are served from a
+// SharedContactStore; changes also go through store and are committed to its
+// journal before they are acknowledged.
+//
+// Runs until SIGINT or SIGTERM and returns the process exit code. With
+// workers == 0 one worker per hardware thread is started.
+int runServer(ContactStore& store, const std::string& socketPath, unsigned workers = 0);
+
+#endif // CONTACT_SERVER_H
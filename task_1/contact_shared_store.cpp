@@ -0,0 +1,275 @@
+#include "contact_shared_store.h"
+
+#include "phone_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+// Builds the next version from the current one. Pages and index shards are
+// shared with the base version until first written, then copied once.
+class SharedContactStore::Edit
+{
+public:
+    explicit Edit(const View& base)
+        : next_(std::make_shared<View>(base))
+    {
+    }
+
+    std::size_t size() const noexcept { return next_->size_; }
+
+    Handle findByEmail(std::string_view email) const { return next_->findByEmail(email); }
+
+    Contact& slot(Handle handle) { return page(handle / kPageSize)[handle % kPageSize]; }
+
+    View::PhoneShard& shard(std::uint64_t phone)
+    {
+        std::size_t i = View::shardOf(phone);
+        if (!phoneShards_[i])
+        {
+            auto copy = std::make_shared<View::PhoneShard>(*next_->byPhone_[i]);
+            phoneShards_[i] = copy.get();
+            next_->byPhone_[i] = std::move(copy);
+        }
+        return *phoneShards_[i];
+    }
+
+    void indexPhones(const Contact& contact, Handle handle)
+    {
+        for (std::uint64_t key : PhoneIndex::keysOf(contact))
+            shard(key).emplace(key, handle);
+    }
+
+    void unindexPhones(const Contact& contact, Handle handle)
+    {
+        for (std::uint64_t key : PhoneIndex::keysOf(contact))
+        {
+            View::PhoneShard& s = shard(key);
+            auto range = s.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == handle)
+                {
+                    s.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    View::EmailShard& shard(std::string_view email)
+    {
+        std::size_t i = View::shardOf(email);
+        if (!shards_[i])
+        {
+            auto copy = std::make_shared<View::EmailShard>(*next_->byEmail_[i]);
+            shards_[i] = copy.get();
+            next_->byEmail_[i] = std::move(copy);
+        }
+        return *shards_[i];
+    }
+
+    void push_back(const Contact& contact)
+    {
+        std::size_t handle = next_->size_;
+        if (handle % kPageSize == 0)
+        {
+            auto fresh = std::make_shared<View::Page>();
+            fresh->reserve(kPageSize);
+            pages_.emplace_back(next_->pages_.size(), fresh.get());
+            next_->pages_.push_back(std::move(fresh));
+        }
+
+        page(handle / kPageSize).push_back(contact);
+        shard(contact.getemail())[contact.getemail()] = handle;
+        indexPhones(contact, handle);
+        ++next_->size_;
+    }
+
+    void pop_back()
+    {
+        std::size_t last = --next_->size_;
+        page(last / kPageSize).pop_back();
+        if (last % kPageSize == 0)
+            next_->pages_.pop_back();
+    }
+
+    std::shared_ptr<const View> done() { return next_; }
+
+private:
+    View::Page& page(std::size_t i)
+    {
+        // Edits touch few pages, mostly the last one copied, so look from the back.
+        for (auto it = pages_.rbegin(); it != pages_.rend(); ++it)
+        {
+            if (it->first == i)
+                return *it->second;
+        }
+
+        auto copy = std::make_shared<View::Page>(*next_->pages_[i]);
+        pages_.emplace_back(i, copy.get());
+        next_->pages_[i] = std::move(copy);
+        return *pages_.back().second;
+    }
+
+    std::shared_ptr<View>                            next_;
+    std::vector<std::pair<std::size_t, View::Page*>> pages_;
+    View::EmailShard*                                shards_[kEmailShards] = {};
+    View::PhoneShard*                                phoneShards_[kPhoneShards] = {};
+};
+
+std::size_t SharedContactStore::View::shardOf(std::string_view email)
+{
+    return std::hash<std::string_view>()(email) % kEmailShards;
+}
+
+std::size_t SharedContactStore::View::shardOf(std::uint64_t phone)
+{
+    return std::hash<std::uint64_t>()(phone) % kPhoneShards;
+}
+
+SharedContactStore::Handle SharedContactStore::View::findByPhone(std::uint64_t key) const
+{
+    const PhoneShard& shard = *byPhone_[shardOf(key)];
+    auto range = shard.equal_range(key);
+
+    Handle first = npos;
+    for (auto it = range.first; it != range.second; ++it)
+        first = std::min(first, it->second);
+    return first;
+}
+
+SharedContactStore::Handle SharedContactStore::View::findByEmail(std::string_view email) const
+{
+    const EmailShard& shard = *byEmail_[shardOf(email)];
+    auto it = shard.find(email);
+    return it == shard.end() ? npos : it->second;
+}
+
+std::size_t SharedContactStore::View::visit(const Visitor& visit, std::size_t limit) const
+{
+    std::size_t count = 0;
+    for (Handle h = 0; h < size_ && count < limit; ++h)
+    {
+        ++count;
+        if (!visit(h, at(h)))
+            break;
+    }
+    return count;
+}
+
+SharedContactStore::SharedContactStore()
+    : SharedContactStore(std::vector<Contact>())
+{
+}
+
+SharedContactStore::SharedContactStore(const std::vector<Contact>& contacts)
+{
+    auto first = std::make_shared<View>();
+    first->byEmail_.reserve(kEmailShards);
+    for (std::size_t i = 0; i < kEmailShards; ++i)
+        first->byEmail_.push_back(std::make_shared<View::EmailShard>());
+
+    first->byPhone_.reserve(kPhoneShards);
+    for (std::size_t i = 0; i < kPhoneShards; ++i)
+        first->byPhone_.push_back(std::make_shared<View::PhoneShard>());
+    current_ = first;
+
+    // Later records with an already known e-mail are dropped: the first one wins.
+    Edit edit(*first);
+    for (const Contact& c : contacts)
+    {
+        if (edit.findByEmail(c.getemail()) == npos)
+            edit.push_back(c);
+    }
+    current_ = edit.done();
+}
+
+std::shared_ptr<const SharedContactStore::View> SharedContactStore::view() const
+{
+    return std::atomic_load(&current_);
+}
+
+bool SharedContactStore::add(const Contact& contact)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    std::shared_ptr<const View> base = current_;
+
+    if (base->findByEmail(contact.getemail()) != npos)
+        return false;
+
+    Edit edit(*base);
+    edit.push_back(contact);
+    publish(edit.done());
+    return true;
+}
+
+bool SharedContactStore::remove(std::string_view email)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    std::shared_ptr<const View> base = current_;
+
+    Handle handle = base->findByEmail(email);
+    if (handle == npos)
+        return false;
+
+    Edit edit(*base);
+    edit.shard(email).erase(email);
+    edit.unindexPhones(base->at(handle), handle);
+
+    // Move the last contact into the freed slot, as ContactStore does.
+    Handle last = edit.size() - 1;
+    if (handle != last)
+    {
+        const Contact& moved = base->at(last);
+        edit.unindexPhones(moved, last);
+        edit.slot(handle) = moved;
+        edit.shard(moved.getemail())[moved.getemail()] = handle;
+        edit.indexPhones(moved, handle);
+    }
+    edit.pop_back();
+
+    publish(edit.done());
+    return true;
+}
+
+bool SharedContactStore::replace(std::string_view email, const Contact& contact)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    std::shared_ptr<const View> base = current_;
+
+    Handle handle = base->findByEmail(email);
+    if (handle == npos)
+        return false;
+
+    bool emailChanged = contact.getemail() != email;
+    if (emailChanged && base->findByEmail(contact.getemail()) != npos)
+        return false;
+
+    // Re-keyed even when the e-mail is the same, so the key views the bytes of
+    // the new contact rather than those of the one it replaces.
+    Edit edit(*base);
+    edit.shard(email).erase(email);
+    edit.shard(contact.getemail())[contact.getemail()] = handle;
+    edit.unindexPhones(base->at(handle), handle);
+    edit.indexPhones(contact, handle);
+    edit.slot(handle) = contact;
+
+    publish(edit.done());
+    return true;
+}
+
+std::vector<Contact> SharedContactStore::contacts() const
+{
+    std::shared_ptr<const View> v = view();
+
+    std::vector<Contact> result;
+    result.reserve(v->size());
+    v->visit([&](Handle, const Contact& c) { result.push_back(c); return true; });
+    return result;
+}
+
+void SharedContactStore::publish(std::shared_ptr<const View> next)
+{
+    std::atomic_store(&current_, std::move(next));
+}
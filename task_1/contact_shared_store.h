@@ -0,0 +1,94 @@
+#ifndef CONTACT_SHARED_STORE_H
+#define CONTACT_SHARED_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Contact_class.h"
+
+// Contact store for many reader threads and concurrent writers. Readers take a
+// View, an immutable version of the whole store, and keep using it for as long
+// as they hold it; nothing they can reach is ever modified. Writers serialize
+// among themselves, build the next version by copying only the page of
+// contacts and the e-mail and phone index shards they touch, and publish it with one
+// atomic pointer swap, so a writer never blocks a reader. A version is freed
+// when the last reader holding it lets go.
+//
+// E-mails are unique, as in ContactStore. Handles are slots of one View and
+// mean nothing in another; writes are therefore keyed by e-mail.
+class SharedContactStore
+{
+public:
+    using Handle = std::size_t;
+    static constexpr Handle npos = static_cast<Handle>(-1);
+
+    // Called for each contact in turn; returning false stops the walk.
+    using Visitor = std::function<bool(Handle, const Contact&)>;
+
+    static constexpr std::size_t kPageSize    = 256;
+    static constexpr std::size_t kEmailShards = 64;
+    static constexpr std::size_t kPhoneShards = 64;
+
+    class View
+    {
+    public:
+        std::size_t size()  const noexcept { return size_; }
+        bool        empty() const noexcept { return size_ == 0; }
+
+        const Contact& at(Handle handle) const { return (*pages_[handle / kPageSize])[handle % kPageSize]; }
+        Handle         findByEmail(std::string_view email) const;
+
+        // Contact in the lowest slot having the number (a PhoneIndex::key()), npos if none.
+        Handle         findByPhone(std::uint64_t key) const;
+
+        // Visits at most limit contacts in slot order and returns how many were visited.
+        std::size_t visit(const Visitor& visit, std::size_t limit = npos) const;
+
+    private:
+        friend class SharedContactStore;
+
+        using Page       = std::vector<Contact>;
+        using EmailShard = std::unordered_map<std::string_view, Handle>;
+        using PhoneShard = std::unordered_multimap<std::uint64_t, Handle>;
+
+        static std::size_t shardOf(std::string_view email);
+        static std::size_t shardOf(std::uint64_t phone);
+
+        std::vector<std::shared_ptr<const Page>>       pages_;
+        std::vector<std::shared_ptr<const EmailShard>> byEmail_;
+        std::vector<std::shared_ptr<const PhoneShard>> byPhone_;
+        std::size_t                                    size_ = 0;
+    };
+
+    SharedContactStore();
+    explicit SharedContactStore(const std::vector<Contact>& contacts);
+
+    SharedContactStore(const SharedContactStore&)            = delete;
+    SharedContactStore& operator=(const SharedContactStore&) = delete;
+
+    // Current version. Readers never wait for an edit in progress, only for
+    // the pointer swap that publishes it.
+    std::shared_ptr<const View> view() const;
+
+    bool add    (const Contact& contact);
+    bool remove (std::string_view email);
+    bool replace(std::string_view email, const Contact& contact);
+
+    // Copy of the current contacts, e.g. for saveContacts().
+    std::vector<Contact> contacts() const;
+
+private:
+    class Edit;
+
+    void publish(std::shared_ptr<const View> next);
+
+    std::shared_ptr<const View> current_;
+    std::mutex                  writeMutex_;
+};
+
+#endif // CONTACT_SHARED_STORE_H
@@ -0,0 +1,213 @@
+#include "contact_snapshot.h"
+#include "contact_profile.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace
+{
+    using Date      = Contact::Date;
+
+    const char          kMagic[4]    = { '\x89', 'C', 'B', 'K' };
+    const std::uint32_t kVersion     = 2;
+    const std::size_t   kHeaderSize  = 32;
+    const std::size_t   kRecordSize  = 56;
+    const std::size_t   kPhoneSize   = 8;
+
+    void put8 (std::string& out, std::uint8_t v) { out.push_back(static_cast<char>(v)); }
+    void put16(std::string& out, std::uint16_t v) { for (int i = 0; i < 2; ++i) put8(out, static_cast<std::uint8_t>(v >> (8 * i))); }
+    void put32(std::string& out, std::uint32_t v) { for (int i = 0; i < 4; ++i) put8(out, static_cast<std::uint8_t>(v >> (8 * i))); }
+    void put64(std::string& out, std::uint64_t v) { for (int i = 0; i < 8; ++i) put8(out, static_cast<std::uint8_t>(v >> (8 * i))); }
+
+    std::uint64_t get(const char* p, int bytes)
+    {
+        std::uint64_t v = 0;
+        for (int i = bytes - 1; i >= 0; --i)
+            v = (v << 8) | static_cast<unsigned char>(p[i]);
+        return v;
+    }
+
+    // Appends strings to the table once; repeated names and numbers share one copy.
+    class StringTable
+    {
+    public:
+        void put(std::string& out, std::string_view s)
+        {
+            std::string key(s);
+            auto it = offsets_.find(key);
+            if (it == offsets_.end())
+            {
+                it = offsets_.emplace(std::move(key), bytes_.size()).first;
+                bytes_ += s;
+            }
+            put32(out, static_cast<std::uint32_t>(it->second));
+            put32(out, static_cast<std::uint32_t>(s.size()));
+        }
+
+        const std::string& bytes() const noexcept { return bytes_; }
+
+    private:
+        std::string                                  bytes_;
+        std::unordered_map<std::string, std::size_t> offsets_;
+    };
+
+    bool getString(const char* p, std::string_view strings, std::string_view& s)
+    {
+        std::uint64_t offset = get(p, 4);
+        std::uint64_t length = get(p + 4, 4);
+        if (offset + length > strings.size())
+            return false;
+
+        s = strings.substr(static_cast<std::size_t>(offset), static_cast<std::size_t>(length));
+        return true;
+    }
+
+    bool parseRecords(std::string_view data, std::vector<Contact>& contacts)
+    {
+        if (!isSnapshot(data))
+            return false;
+
+        if (get(data.data() + 4, 4) != kVersion)
+            return false;
+
+        std::uint64_t recordCount  = get(data.data() + 8,  8);
+        std::uint64_t phoneCount   = get(data.data() + 16, 8);
+        std::uint64_t stringOffset = get(data.data() + 24, 8);
+
+        std::uint64_t phonesOffset = kHeaderSize + recordCount * kRecordSize;
+        if (recordCount > data.size() / kRecordSize || phoneCount > data.size() / kPhoneSize ||
+            phonesOffset + phoneCount * kPhoneSize != stringOffset || stringOffset > data.size())
+            return false;
+
+        std::string_view strings = data.substr(static_cast<std::size_t>(stringOffset));
+        const char* phoneTable   = data.data() + phonesOffset;
+
+        contacts.reserve(static_cast<std::size_t>(recordCount));
+
+        std::string_view name, surname, patronymic, email, address;
+        Contact::PackedPhone phone;
+
+        for (std::uint64_t i = 0; i < recordCount; ++i)
+        {
+            const char* r = data.data() + kHeaderSize + i * kRecordSize;
+
+            if (!getString(r,      strings, name)       ||
+                !getString(r + 8,  strings, surname)    ||
+                !getString(r + 16, strings, patronymic) ||
+                !getString(r + 24, strings, email)      ||
+                !getString(r + 32, strings, address))
+                return false;
+
+            Date d{};
+            d.day   = static_cast<int>(get(r + 40, 1));
+            d.month = static_cast<int>(get(r + 41, 1));
+            d.year  = static_cast<std::int32_t>(get(r + 44, 4));
+
+            std::uint64_t firstPhone = get(r + 48, 4);
+            std::uint64_t phoneTotal = get(r + 52, 4);
+            if (firstPhone + phoneTotal > phoneCount)
+                return false;
+
+            Contact::PhoneList phones;
+            for (std::uint64_t k = 0; k < phoneTotal; ++k)
+            {
+                if (!Contact::PackedPhone::fromBits(get(phoneTable + (firstPhone + k) * kPhoneSize, 8), phone))
+                    return false;
+                phones.push_back(phone);
+            }
+
+            contacts.emplace_back(name, surname, patronymic, email, address, d, std::move(phones));
+        }
+
+        return true;
+    }
+}
+
+bool isSnapshot(std::string_view data)
+{
+    return data.size() >= kHeaderSize && data.compare(0, 4, std::string_view(kMagic, 4)) == 0;
+}
+
+bool isSnapshotFile(const std::string& filename)
+{
+    MappedFile file;
+    return file.open(filename) && isSnapshot(file.view());
+}
+
+bool parseSnapshot(std::string_view data, std::vector<Contact>& contacts)
+{
+    PROFILE_SCOPE("snapshot.parse");
+    contacts.clear();
+
+    // A damaged snapshot yields nothing rather than the records before the damage.
+    if (!parseRecords(data, contacts))
+    {
+        contacts.clear();
+        return false;
+    }
+    return true;
+}
+
+bool saveSnapshot(const std::string& filename, const std::vector<Contact>& contacts)
+{
+    PROFILE_SCOPE("snapshot.save");
+    std::string records;
+    std::string phoneTable;
+    StringTable strings;
+    std::uint32_t phoneCount = 0;
+
+    records.reserve(contacts.size() * kRecordSize);
+
+    for (const Contact& c : contacts)
+    {
+        const auto& phones = c.getPhones();
+        const Date& d     = c.getBirth_date();
+
+        strings.put(records, c.getName());
+        strings.put(records, c.getSurname());
+        strings.put(records, c.getPatronymic());
+        strings.put(records, c.getemail());
+        strings.put(records, c.getAddress());
+
+        put8 (records, static_cast<std::uint8_t>(d.day));
+        put8 (records, static_cast<std::uint8_t>(d.month));
+        put16(records, 0);
+        put32(records, static_cast<std::uint32_t>(d.year));
+
+        put32(records, phoneCount);
+        put32(records, static_cast<std::uint32_t>(phones.size()));
+
+        for (const Contact::PackedPhone& p : phones)
+            put64(phoneTable, p.bits());
+        phoneCount += static_cast<std::uint32_t>(phones.size());
+    }
+
+    // String refs are 32-bit.
+    if (strings.bytes().size() > UINT32_MAX)
+        return false;
+
+    std::string header(kMagic, 4);
+    put32(header, kVersion);
+    put64(header, contacts.size());
+    put64(header, phoneCount);
+    put64(header, kHeaderSize + records.size() + phoneTable.size());
+
+    const std::string tmpName = filename + ".tmp";
+    {
+        std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+
+        out << header << records << phoneTable << strings.bytes();
+        out.flush();
+        if (!out)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpName, filename, ec);
+    return !ec;
+}
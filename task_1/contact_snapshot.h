@@ -0,0 +1,31 @@
+#ifndef CONTACT_SNAPSHOT_H
+#define CONTACT_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Contact_class.h"
+
+// Binary snapshot of a contact list, all integers little-endian:
+//
+//   header   magic "\x89" "CBK", u32 version, u64 record count,
+//            u64 phone count, u64 string table offset
+//   records  fixed 56 bytes each: five string refs (name, surname, patronymic,
+//            e-mail, address), u8 day, u8 month, u16 reserved, i32 year,
+//            u32 first phone, u32 phone count
+//   phones   fixed 8 bytes each: the u64 of Contact::PackedPhone::bits()
+//   strings  the raw bytes every string ref {u32 offset, u32 length} points into
+//
+// Contacts are validated before they are written, so loading a snapshot does
+// no parsing and no re-validation, only bounds checks. A snapshot of any other
+// version is refused.
+
+bool isSnapshot    (std::string_view data);
+bool isSnapshotFile(const std::string& filename);
+
+// On failure contacts is left empty.
+bool parseSnapshot(std::string_view data, std::vector<Contact>& contacts);
+
+bool saveSnapshot (const std::string& filename, const std::vector<Contact>& contacts);
+
+#endif // CONTACT_SNAPSHOT_H
@@ -1,164 +1,590 @@
-#include "contact_storage.h"
-#include "Contact_class.h"
-
-#include <fstream>
-#include <sstream>
-
-namespace
-{
-    using Date      = Contact::Date;
-    using Phone     = Contact::Phone;
-    using PhoneType = Contact::PhoneType;
-
-    std::string formatDate(const Date& d)
-    {
-        std::ostringstream os;
-        if (d.day < 10)   os << '0';
-        os << d.day << '.';
-        if (d.month < 10) os << '0';
-        os << d.month << '.';
-        os << d.year;
-        return os.str();
-    }
-
-    bool parseDate(const std::string& text, Date& out)
-    {
-        std::istringstream is(text);
-        char dot1 = 0, dot2 = 0;
-        if (!(is >> out.day >> dot1 >> out.month >> dot2 >> out.year))
-            return false;
-
-        if (dot1 != '.' || dot2 != '.')
-            return false;
-
-        if (!Contact::isValidDate(out))
-            return false;
-
-        return true;
-    }
-
-    std::string phoneTypeToString(Contact::PhoneType t)
-    {
-        switch (t)
-        {
-        case Contact::PhoneType::Work:   return "Work";
-        case Contact::PhoneType::Home:   return "Home";
-        case Contact::PhoneType::Service:return "Service";
-        }
-        return "Unknown";
-    }
-
-    bool stringToPhoneType(const std::string& s, Contact::PhoneType& t)
-    {
-        if (s == "Work")   { t = Contact::PhoneType::Work;   return true; }
-        if (s == "Home")   { t = Contact::PhoneType::Home;   return true; }
-        if (s == "Service"){ t = Contact::PhoneType::Service;return true; }
-        return false;
-    }
-
-}
-
-bool loadContacts(const std::string& filename, std::vector<Contact>& contacts)
-{
-    contacts.clear();
-
-    std::ifstream in(filename);
-    if (!in.is_open())
-        return true;
-
-    std::string line;
-    while (std::getline(in, line))
-    {
-        if (line.empty())
-            continue;
-
-        std::istringstream iss(line);
-        std::string name;
-        std::string surname;
-        std::string patronymic;
-        std::string address;
-        std::string dateStr;
-        std::string email;
-        std::string phonesStr;
-
-        if (!std::getline(iss, name,       '|')) continue;
-        if (!std::getline(iss, surname,    '|')) continue;
-        if (!std::getline(iss, patronymic, '|')) continue;
-        if (!std::getline(iss, address,    '|')) continue;
-        if (!std::getline(iss, dateStr,    '|')) continue;
-        if (!std::getline(iss, email,      '|')) continue;
-        std::getline(iss, phonesStr);
-
-        Date birth{};
-        if (!parseDate(dateStr, birth))
-            continue;
-
-        std::vector<Phone> phones;
-        std::istringstream pss(phonesStr);
-        std::string phoneToken;
-
-        while (std::getline(pss, phoneToken, ','))
-        {
-            if (phoneToken.empty())
-                continue;
-
-            std::size_t colonPos = phoneToken.find(':');
-            if (colonPos == std::string::npos)
-                continue;
-
-            std::string typeStr = phoneToken.substr(0, colonPos);
-            std::string number  = phoneToken.substr(colonPos + 1);
-
-            PhoneType type;
-            if (!stringToPhoneType(typeStr, type))
-                continue;
-
-            Phone p{ type, number };
-            phones.push_back(p);
-        }
-
-        if (phones.empty())
-            continue;
-
-        Contact c(name, surname, email, phones);
-        c.setPatronymic(patronymic);
-        c.setAddress(address);
-        c.setDate(birth);
-
-        contacts.push_back(c);
-    }
-
-    return true;
-}
-
-bool saveContacts(const std::string& filename, const std::vector<Contact>& contacts)
-{
-    std::ofstream out(filename);
-    if (!out.is_open())
-        return false;
-
-    for (const Contact& c : contacts)
-    {
-        const Date& d = c.getBirth_date();
-        auto phones   = c.getPhones();
-
-        out << c.getName()        << '|'
-            << c.getSurname()     << '|'
-            << c.getPatronymic()  << '|'
-            << c.getAddress()     << '|'
-            << formatDate(d)      << '|'
-            << c.getemail()       << '|';
-
-        for (std::size_t i = 0; i < phones.size(); ++i)
-        {
-            const Phone& p = phones[i];
-            out << phoneTypeToString(p.type) << ':' << p.number;
-            if (i + 1 < phones.size())
-                out << ',';
-        }
-
-        out << '\n';
-    }
-
-    return true;
-}
+#include "contact_storage.h"
+#include "Contact_class.h"
+#include "contact_codec.h"
+#include "contact_snapshot.h"
+#include "contact_writer.h"
+#include "contact_profile.h"
+#include "field_scan.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+namespace
+{
+    using Date      = Contact::Date;
+    using PhoneType = Contact::PhoneType;
+
+    // Cuts the next delimiter-terminated field off the front of text. The last
+    // field may run to the end of text, as with std::getline.
+    bool nextField(std::string_view& text, char delim, std::string_view& field)
+    {
+        if (text.empty())
+            return false;
+
+        std::size_t pos = text.find(delim);
+        field = text.substr(0, pos);
+        text.remove_prefix(pos == std::string_view::npos ? text.size() : pos + 1);
+        return true;
+    }
+
+    std::string_view fieldBetween(std::string_view line, std::size_t from, std::size_t bar)
+    {
+        return line.substr(from, bar - from);
+    }
+
+    // Parses one record straight from the mapped bytes and constructs the
+    // contact at the end of out. Malformed records leave out untouched.
+    // A record needs all six separators: without the last one its phone list
+    // would be empty, and such records were always skipped. A record with a
+    // number PackedPhone cannot hold is not taken either, and badPhone is set.
+    bool appendContact(std::string_view line, const RecordSplit& split,
+                       const Contact::ValidationContext& ctx, std::vector<Contact>& out, bool& badPhone)
+    {
+        badPhone = false;
+        PROFILE_SCOPE("storage.parse_record");
+        if (split.barCount < RecordSplit::kMaxBars)
+            return false;
+
+        const std::size_t* bar = split.bars;
+        std::string_view name       = fieldBetween(line, 0,          bar[0]);
+        std::string_view surname    = fieldBetween(line, bar[0] + 1, bar[1]);
+        std::string_view patronymic = fieldBetween(line, bar[1] + 1, bar[2]);
+        std::string_view address    = fieldBetween(line, bar[2] + 1, bar[3]);
+        std::string_view dateStr    = fieldBetween(line, bar[3] + 1, bar[4]);
+        std::string_view email      = fieldBetween(line, bar[4] + 1, bar[5]);
+        std::string_view phonesStr  = line.substr(bar[5] + 1);
+
+        Date birth{};
+        if (!parseDate(dateStr, birth) || !Contact::isValidDate(birth, ctx))
+            return false;
+
+        Contact::PhoneList phones;
+        std::string_view phoneToken;
+
+        while (nextField(phonesStr, ',', phoneToken))
+        {
+            std::size_t colonPos = phoneToken.find(':');
+            if (colonPos == std::string_view::npos)
+                continue;
+
+            PhoneType type;
+            if (!parsePhoneType(phoneToken.substr(0, colonPos), type))
+                continue;
+
+            if (!phones.add(type, phoneToken.substr(colonPos + 1)))
+            {
+                badPhone = true;
+                return false;
+            }
+        }
+
+        if (phones.empty())
+            return false;
+
+        Contact& c = out.emplace_back(name, surname, email, std::move(phones));
+        c.setPatronymic(patronymic);
+        c.setAddress(address);
+        c.setDate(birth, ctx);
+        return true;
+    }
+
+    // Smallest slice of the file worth handing to its own thread.
+    const std::size_t kMinChunkBytes = 1 << 20;
+
+    // Lines with text on them. The '\n' padding that ends each page of a paged
+    // file holds no record, so parseChunk() must not reserve room for it.
+    std::size_t countRecords(std::string_view text)
+    {
+        std::size_t count = 0;
+        const char* p   = text.data();
+        const char* end = p + text.size();
+        while (p < end)
+        {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+            if (!nl)
+                return count + 1;
+            count += nl != p;
+            p = nl + 1;
+        }
+        return count;
+    }
+
+    // Parses every record of text into out. With spans, also notes where each
+    // record sits, as an offset from base; with rejected, collects the records
+    // turned down for a number that cannot be stored.
+    void parseChunk(std::string_view text, const Contact::ValidationContext& ctx, std::vector<Contact>& out,
+                    const char* base = nullptr, std::vector<RecordSpan>* spans = nullptr,
+                    std::vector<std::string>* rejected = nullptr)
+    {
+        out.reserve(out.size() + countRecords(text));
+
+        bool badPhone = false;
+        while (!text.empty())
+        {
+            RecordSplit split = scanRecord(text);
+            std::string_view line = text.substr(0, split.length);
+            if (appendContact(line, split, ctx, out, badPhone))
+            {
+                if (spans)
+                    spans->push_back(RecordSpan{ static_cast<std::uint64_t>(text.data() - base),
+                                                 static_cast<std::uint32_t>(split.length) });
+            }
+            else if (badPhone && rejected)
+            {
+                rejected->emplace_back(line);
+            }
+            text.remove_prefix(std::min(split.length + 1, text.size()));
+        }
+    }
+
+    void putU64(std::string& out, std::uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i)
+            out += static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+
+    std::uint64_t getU64(const char* p)
+    {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        return v;
+    }
+
+    // Layout of "<file>.pages": magic, then per page u64 offset, u64 size and
+    // the bytes, then the end marker that makes the log complete.
+    const char kPagesMagic[] = "CPG1";
+    const char kPagesEnd[]   = "END!";
+
+    bool patchPages(const std::string& filename, const std::vector<PageImage>& pages)
+    {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open())
+            return false;
+
+        for (const PageImage& page : pages)
+        {
+            file.seekp(static_cast<std::streamoff>(page.offset));
+            file.write(page.bytes.data(), static_cast<std::streamsize>(page.bytes.size()));
+        }
+        file.flush();
+        return static_cast<bool>(file);
+    }
+
+}
+
+std::optional<Contact> parseContactLine(std::string_view line)
+{
+    std::vector<Contact> one;
+    bool badPhone = false;
+    if (!appendContact(line, scanRecord(line), Contact::ValidationContext::now(), one, badPhone))
+        return std::nullopt;
+
+    return std::move(one.back());
+}
+
+void appendContactLine(std::string& out, const Contact& c)
+{
+    const Date& d = c.getBirth_date();
+    const auto& phones = c.getPhones();
+
+    out.append(c.getName())       += '|';
+    out.append(c.getSurname())    += '|';
+    out.append(c.getPatronymic()) += '|';
+    out.append(c.getAddress())    += '|';
+    appendDate(out, d);
+    out += '|';
+    out.append(c.getemail())      += '|';
+
+    char number[Contact::PackedPhone::kMaxLength];
+    for (std::size_t i = 0; i < phones.size(); ++i)
+    {
+        const Contact::PackedPhone& p = phones[i];
+        out.append(phoneTypeName(p.type())) += ':';
+        out.append(number, p.format(number));
+        if (i + 1 < phones.size())
+            out += ',';
+    }
+}
+
+std::string formatContactLine(const Contact& c)
+{
+    std::string line;
+    appendContactLine(line, c);
+    return line;
+}
+
+bool loadContacts(const std::string& filename, std::vector<Contact>& contacts)
+{
+    PROFILE_SCOPE("storage.load");
+    contacts.clear();
+
+    // No file yet means no contacts; one that cannot be read is an error.
+    MappedFile file;
+    if (!file.open(filename))
+        return file.missing();
+
+    if (isSnapshot(file.view()))
+        return parseSnapshot(file.view(), contacts);
+
+    parseChunk(file.view(), Contact::ValidationContext::now(), contacts);
+    PROFILE_COUNT("storage.records_loaded", contacts.size());
+    return true;
+}
+
+bool loadContactsParallel(const std::string& filename, std::vector<Contact>& contacts, unsigned threads,
+                          std::vector<RecordSpan>* spans, std::vector<std::string>* rejected)
+{
+    PROFILE_SCOPE("storage.load_parallel");
+    contacts.clear();
+    if (spans)
+        spans->clear();
+    if (rejected)
+        rejected->clear();
+
+    // No file yet means no contacts; one that cannot be read is an error.
+    MappedFile file;
+    if (!file.open(filename))
+        return file.missing();
+
+    std::string_view text = file.view();
+
+    if (isSnapshot(text))
+        return parseSnapshot(text, contacts);
+
+    // One clock read for the whole file, shared read-only by every worker.
+    const Contact::ValidationContext ctx = Contact::ValidationContext::now();
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::size_t chunkCount = std::min<std::size_t>(threads, text.size() / kMinChunkBytes);
+    if (chunkCount <= 1)
+    {
+        parseChunk(text, ctx, contacts, text.data(), spans, rejected);
+        PROFILE_COUNT("storage.records_loaded", contacts.size());
+        return true;
+    }
+
+    // Cut at the first newline after each even split point so no record straddles two chunks.
+    std::vector<std::string_view> chunks;
+    std::size_t begin = 0;
+    for (std::size_t i = 1; i <= chunkCount && begin < text.size(); ++i)
+    {
+        std::size_t end = text.size();
+        if (i < chunkCount)
+        {
+            end = text.find('\n', std::max(begin, text.size() / chunkCount * i));
+            end = end == std::string_view::npos ? text.size() : end + 1;
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    std::vector<std::vector<Contact>>    parts(chunks.size());
+    std::vector<std::vector<RecordSpan>> partSpans(spans ? chunks.size() : 0);
+    std::vector<std::vector<std::string>> partRejected(rejected ? chunks.size() : 0);
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size() - 1);
+
+    auto spansOf    = [&](std::size_t i) { return spans ? &partSpans[i] : nullptr; };
+    auto rejectedOf = [&](std::size_t i) { return rejected ? &partRejected[i] : nullptr; };
+    for (std::size_t i = 1; i < chunks.size(); ++i)
+        workers.emplace_back(parseChunk, chunks[i], std::cref(ctx), std::ref(parts[i]), text.data(), spansOf(i),
+                             rejectedOf(i));
+    parseChunk(chunks[0], ctx, parts[0], text.data(), spansOf(0), rejectedOf(0));
+
+    for (std::thread& t : workers)
+        t.join();
+
+    // Merging in chunk order keeps the records in file order.
+    std::size_t total = 0;
+    for (const auto& part : parts)
+        total += part.size();
+
+    contacts = std::move(parts[0]);
+    contacts.reserve(total);
+    for (std::size_t i = 1; i < parts.size(); ++i)
+        std::move(parts[i].begin(), parts[i].end(), std::back_inserter(contacts));
+
+    if (spans)
+    {
+        spans->reserve(total);
+        for (const auto& part : partSpans)
+            spans->insert(spans->end(), part.begin(), part.end());
+    }
+
+    if (rejected)
+    {
+        for (auto& part : partRejected)
+            std::move(part.begin(), part.end(), std::back_inserter(*rejected));
+    }
+
+    PROFILE_COUNT("storage.records_loaded", contacts.size());
+    return true;
+}
+
+bool saveContacts(const std::string& filename, const std::vector<Contact>& contacts)
+{
+    PROFILE_SCOPE("storage.save");
+    // Write next to the target and rename over it, so readers never see a half-written file.
+    const std::string tmpName = filename + ".tmp";
+    {
+        std::ofstream out(tmpName, std::ios::trunc);
+        if (!out.is_open())
+            return false;
+
+        // Records are formatted into one reused buffer and written in large chunks.
+        std::string buffer;
+        for (const Contact& c : contacts)
+        {
+            appendContactLine(buffer, c);
+            buffer += '\n';
+            if (buffer.size() >= kWriteChunk)
+            {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+        out.flush();
+        if (!out)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpName, filename, ec);
+    return !ec;
+}
+
+bool saveContactsPaged(const std::string& filename, const std::vector<Contact>& contacts,
+                       std::vector<RecordSpan>& spans)
+{
+    PROFILE_SCOPE("storage.save_paged");
+    spans.clear();
+    spans.reserve(contacts.size());
+
+    const std::string tmpName = filename + ".tmp";
+    {
+        std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+
+        // written counts the bytes already handed to the stream; the page being
+        // filled is [pageBegin, pageEnd) of the whole file.
+        std::string   buffer;
+        std::uint64_t written   = 0;
+        std::uint64_t pageBegin = 0;
+        std::uint64_t pageEnd   = kRecordPageSize;
+
+        for (const Contact& c : contacts)
+        {
+            std::size_t   start = buffer.size();
+            appendContactLine(buffer, c);
+            std::uint64_t need  = buffer.size() - start + 1;
+            std::uint64_t pos   = written + start;
+
+            if (pos + need > pageEnd)
+            {
+                // Pad the page out and start the record on a fresh one.
+                std::string record = buffer.substr(start);
+                buffer.resize(start);
+                if (pos > pageBegin)
+                {
+                    buffer.append(static_cast<std::size_t>(pageEnd - pos), '\n');
+                    pageBegin = pageEnd;
+                }
+                pageEnd = pageBegin + (need + kRecordPageSize - 1) / kRecordPageSize * kRecordPageSize;
+                pos     = pageBegin;
+                start   = buffer.size();
+                buffer += record;
+            }
+
+            spans.push_back(RecordSpan{ pos, static_cast<std::uint32_t>(need - 1) });
+            buffer += '\n';
+
+            if (buffer.size() >= kWriteChunk)
+            {
+                out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                written += buffer.size();
+                buffer.clear();
+            }
+        }
+
+        if (written + buffer.size() > pageBegin)
+            buffer.append(static_cast<std::size_t>(pageEnd - written - buffer.size()), '\n');
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+        out.flush();
+        if (!out)
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpName, filename, ec);
+    return !ec;
+}
+
+bool writePages(const std::string& filename, const std::vector<PageImage>& pages)
+{
+    PROFILE_SCOPE("storage.write_pages");
+    const std::string logName = filename + ".pages";
+    {
+        std::string log(kPagesMagic, 4);
+        for (const PageImage& page : pages)
+        {
+            putU64(log, page.offset);
+            putU64(log, page.bytes.size());
+            log += page.bytes;
+        }
+        log.append(kPagesEnd, 4);
+
+        std::ofstream out(logName, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+        out.write(log.data(), static_cast<std::streamsize>(log.size()));
+        out.flush();
+        if (!out)
+            return false;
+    }
+
+    if (!patchPages(filename, pages))
+        return false;
+
+    std::error_code ec;
+    std::filesystem::remove(logName, ec);
+    return !ec;
+}
+
+bool recoverPages(const std::string& filename)
+{
+    const std::string logName = filename + ".pages";
+
+    std::vector<PageImage> pages;
+    bool complete = false;
+    {
+        MappedFile log;
+        if (!log.open(logName))
+            return log.missing();
+
+        std::string_view data = log.view();
+        if (data.size() >= 8 && data.substr(0, 4) == std::string_view(kPagesMagic, 4))
+        {
+            std::size_t pos = 4;
+            while (pos + 16 <= data.size())
+            {
+                std::uint64_t offset = getU64(data.data() + pos);
+                std::uint64_t size   = getU64(data.data() + pos + 8);
+                if (size > data.size() - pos - 16)
+                    break;
+
+                pages.push_back(PageImage{ offset, std::string(data.substr(pos + 16, size)) });
+                pos += 16 + size;
+            }
+            complete = pos + 4 == data.size() && data.substr(pos) == std::string_view(kPagesEnd, 4);
+        }
+    }
+
+    if (complete && !patchPages(filename, pages))
+        return false;
+
+    std::error_code ec;
+    std::filesystem::remove(logName, ec);
+    return !ec;
+}
+
+bool appendJournal(const std::string& filename, const std::vector<JournalEntry>& entries)
+{
+    PROFILE_SCOPE("storage.journal_append");
+    std::ofstream out(filename, std::ios::app);
+    if (!out.is_open())
+        return false;
+
+    for (const JournalEntry& e : entries)
+    {
+        switch (e.op)
+        {
+        case JournalOp::Add:    out << "A|"                 << e.record << '\n'; break;
+        case JournalOp::Edit:   out << "E|" << e.key << '|' << e.record << '\n'; break;
+        case JournalOp::Delete: out << "D|" << e.key                    << '\n'; break;
+        }
+    }
+
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+bool readJournal(const std::string& filename, std::vector<JournalEntry>& entries)
+{
+    PROFILE_SCOPE("storage.journal_read");
+    entries.clear();
+
+    // No journal means nothing to replay; one that cannot be read must stop
+    // the open, or its edits would be lost at the next compaction.
+    MappedFile file;
+    if (!file.open(filename))
+        return file.missing();
+
+    std::string_view text = file.view();
+    while (!text.empty())
+    {
+        std::size_t end = std::min(text.find('\n'), text.size());
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(std::min(end + 1, text.size()));
+
+        // A torn last line after a crash simply fails to parse and is dropped.
+        if (line.size() < 2 || line[1] != '|')
+            continue;
+
+        JournalEntry e{};
+        std::string_view rest = line.substr(2);
+        switch (line[0])
+        {
+        case 'A':
+            e.op     = JournalOp::Add;
+            e.record = rest;
+            break;
+        case 'E':
+        {
+            std::size_t bar = rest.find('|');
+            if (bar == std::string_view::npos)
+                continue;
+            e.op     = JournalOp::Edit;
+            e.key    = rest.substr(0, bar);
+            e.record = rest.substr(bar + 1);
+            break;
+        }
+        case 'D':
+            e.op  = JournalOp::Delete;
+            e.key = rest;
+            break;
+        default:
+            continue;
+        }
+
+        entries.push_back(std::move(e));
+    }
+
+    return true;
+}
+
+bool appendLines(const std::string& filename, const std::vector<std::string>& lines)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::app);
+    if (!out.is_open())
+        return false;
+
+    for (const std::string& line : lines)
+        out << line << '\n';
+
+    out.flush();
+    return static_cast<bool>(out);
+}
@@ -1,15 +1,90 @@
-#ifndef CONTACT_STORAGE_H
-#define CONTACT_STORAGE_H
-
-#include <vector>
-#include <string>
-#include "Contact_class.h"
-
-bool loadContacts(const std::string& filename, std::vector<Contact>&       contacts);
-
-bool saveContacts(const std::string& filename, const std::vector<Contact>& contacts);
-
-#endif // CONTACT_STORAGE_H
-
-
-//C:\OOP_uni\pr_without_qt\build\Desktop_Qt_6_9_2_MinGW_64_bit-Debug\contacts.txt
+#ifndef CONTACT_STORAGE_H
+#define CONTACT_STORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <string>
+#include <string_view>
+#include "Contact_class.h"
+
+// Reads either the text format or a binary snapshot (see contact_snapshot.h).
+// A file that does not exist loads as no contacts; false if it exists but
+// cannot be read or parsed.
+bool loadContacts(const std::string& filename, std::vector<Contact>&       contacts);
+
+// Where a loaded record sits in a text file: its first byte and its length
+// without the newline.
+struct RecordSpan
+{
+    std::uint64_t offset;
+    std::uint32_t length;
+};
+
+// Same result as loadContacts, but the file is cut into newline-aligned chunks
+// that are parsed on up to `threads` threads (0 means one per core). With spans,
+// the place of every loaded record is reported too (nothing for a snapshot).
+// Records with a phone number that Contact::PackedPhone cannot hold are not
+// loaded; with rejected, their lines are handed back as they are in the file.
+bool loadContactsParallel(const std::string& filename, std::vector<Contact>& contacts, unsigned threads = 0,
+                          std::vector<RecordSpan>* spans = nullptr, std::vector<std::string>* rejected = nullptr);
+
+bool saveContacts(const std::string& filename, const std::vector<Contact>& contacts);
+
+// Paged text layout: the file is a sequence of pages of kRecordPageSize bytes
+// (a record longer than that gets a page of as many whole blocks as it needs).
+// No record crosses a page end and the unused tail of every page is '\n'
+// padding, which readers skip as blank lines, so a paged file is still an
+// ordinary contacts file and any page can be rewritten in place.
+const std::size_t kRecordPageSize = 4096;
+
+// Writes contacts in the paged layout, through a temporary file like
+// saveContacts, and reports where each record went.
+bool saveContactsPaged(const std::string& filename, const std::vector<Contact>& contacts,
+                       std::vector<RecordSpan>& spans);
+
+// New contents for one page of a paged file, exactly as long as the page.
+struct PageImage
+{
+    std::uint64_t offset;
+    std::string   bytes;
+};
+
+// Overwrites pages of filename in place. The images are first written to
+// "<file>.pages", so if the process dies halfway recoverPages() finishes the
+// job on the next start.
+bool writePages  (const std::string& filename, const std::vector<PageImage>& pages);
+
+// Applies a complete "<file>.pages" left behind by writePages and removes it;
+// an incomplete one is dropped, the file was not touched yet.
+bool recoverPages(const std::string& filename);
+
+std::optional<Contact> parseContactLine  (std::string_view   line);
+
+std::string            formatContactLine (const Contact&     contact);
+
+// Appends the record for contact to out, without the trailing newline.
+void                   appendContactLine (std::string&       out, const Contact& contact);
+
+// Write-ahead journal kept next to the contacts file. Edit and Delete entries
+// are keyed by the e-mail the contact had before the change.
+enum class JournalOp {Add, Edit, Delete};
+struct JournalEntry
+{
+    JournalOp   op;
+    std::string key;
+    std::string record;
+};
+
+bool appendJournal(const std::string& filename, const std::vector<JournalEntry>& entries);
+
+bool readJournal  (const std::string& filename, std::vector<JournalEntry>&       entries);
+
+// Appends each line and a newline to filename, creating the file if needed.
+bool appendLines  (const std::string& filename, const std::vector<std::string>&  lines);
+
+#endif // CONTACT_STORAGE_H
+
+
+//C:\OOP_uni\pr_without_qt\build\Desktop_Qt_6_9_2_MinGW_64_bit-Debug\contacts.txt
@@ -0,0 +1,597 @@
+#include "contact_store.h"
+#include "contact_profile.h"
+#include "contact_snapshot.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    // Fold the journal into the file once it holds this many entries. A paged
+    // rewrite costs at most one page per entry, so this bounds every compact().
+    const std::size_t kMinCompactEntries = 1024;
+
+    // Rewrite the whole file instead once padding and dropped records take more
+    // than the live records plus this much.
+    const std::uint64_t kMaxSlackBytes = 256 * kRecordPageSize;
+}
+
+bool ContactStore::open(const std::string& filename)
+{
+    PROFILE_SCOPE("store.open");
+    // No file is bound while replaying, so log() does not record the journal again.
+    filename_.clear();
+    pending_.clear();
+    rejected_ = 0;
+
+    if (!recoverPages(filename))
+        return false;
+
+    std::vector<Contact>     loaded;
+    std::vector<RecordSpan>  spans;
+    std::vector<std::string> rejected;
+    if (!loadContactsParallel(filename, loaded, 0, &spans, &rejected))
+        return false;
+
+    std::error_code ec;
+    std::uint64_t fileSize = std::filesystem::file_size(filename, ec);
+
+    // Read everything before touching the store, so a failed open leaves no file bound.
+    std::vector<JournalEntry> entries;
+    if (!readJournal(filename + ".journal", entries))
+        return false;
+
+    contacts_ = std::move(loaded);
+    rebuildIndex(spans, rejected);
+    snapshot_ = isSnapshotFile(filename);
+    buildPages(spans, ec ? 0 : fileSize);
+
+    replay(entries);
+    journalSize_ = entries.size();
+    filename_    = filename;
+
+    // Keep the rejected records aside before the file is rewritten without them.
+    rejected_ = rejected.size();
+    if (!rejected.empty() && !(appendLines(rejectedName(), rejected) && compact(true)))
+    {
+        filename_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ContactStore::commit()
+{
+    PROFILE_SCOPE("store.commit");
+    if (pending_.empty())
+        return true;
+
+    if (!appendJournal(journalName(), pending_))
+        return false;
+
+    journalSize_ += pending_.size();
+    pending_.clear();
+
+    // Until the file is paged, compaction rewrites all of it, so it waits for a
+    // quarter of the store to be amortized over.
+    std::size_t threshold = paged_ ? kMinCompactEntries : std::max(kMinCompactEntries, contacts_.size() / 4);
+    if (journalSize_ >= threshold)
+        return compact();
+    return true;
+}
+
+bool ContactStore::compact()
+{
+    return compact(!paged_ || fileSize_ > 2 * liveBytes_ + kMaxSlackBytes);
+}
+
+bool ContactStore::compact(bool repack)
+{
+    PROFILE_SCOPE("store.compact");
+    if (!(repack ? rewriteFile() : writeDirtyPages()))
+        return false;
+
+    // The file already holds every logged change; replaying the old journal
+    // over it after a crash here is harmless because replay() is idempotent.
+    std::ofstream truncate(journalName(), std::ios::trunc);
+    if (!truncate.is_open())
+        return false;
+
+    pending_.clear();
+    journalSize_ = 0;
+    return true;
+}
+
+bool ContactStore::add(const Contact& contact)
+{
+    return emplace(contact);
+}
+
+bool ContactStore::add(Contact&& contact)
+{
+    return emplace(std::move(contact));
+}
+
+// Indexes the contact just appended to contacts_, or drops it again if its e-mail is taken.
+bool ContactStore::indexAdded()
+{
+    PROFILE_SCOPE("store.add");
+    Handle h = contacts_.size() - 1;
+    const Contact& contact = contacts_[h];
+    if (!byEmail_.emplace(contact.getemail(), h).second)
+    {
+        contacts_.pop_back();
+        return false;
+    }
+
+    byName_.insert(nameKey(contact, h));
+    fuzzy_.insert(h, contact);
+    byPhone_.insert(h, contact);
+    if (paged_)
+    {
+        pageOf_.push_back(0);
+        place(h, contact, kFresh);
+    }
+    log(JournalOp::Add, std::string_view(), &contact);
+    return true;
+}
+
+bool ContactStore::remove(Handle handle)
+{
+    PROFILE_SCOPE("store.remove");
+    if (handle >= contacts_.size())
+        return false;
+
+    log(JournalOp::Delete, contacts_[handle].getemail(), nullptr);
+    byEmail_.erase(contacts_[handle].getemail());
+    byName_.erase(nameKey(contacts_[handle], handle));
+    fuzzy_.erase(handle, contacts_[handle]);
+    byPhone_.erase(handle, contacts_[handle]);
+    if (paged_)
+        unplace(handle);
+
+    // Move the last contact into the freed slot so removal stays O(1).
+    Handle last = contacts_.size() - 1;
+    if (handle != last)
+    {
+        byName_.erase(nameKey(contacts_[last], last));
+        fuzzy_.erase(last, contacts_[last]);
+        byPhone_.erase(last, contacts_[last]);
+        contacts_[handle] = std::move(contacts_[last]);
+        byEmail_[contacts_[handle].getemail()] = handle;
+        byName_.insert(nameKey(contacts_[handle], handle));
+        fuzzy_.insert(handle, contacts_[handle]);
+        byPhone_.insert(handle, contacts_[handle]);
+        if (paged_)
+            rekey(last, handle);
+    }
+    contacts_.pop_back();
+    if (paged_)
+        pageOf_.pop_back();
+    return true;
+}
+
+bool ContactStore::replace(Handle handle, const Contact& contact)
+{
+    return replace(handle, Contact(contact));
+}
+
+bool ContactStore::replace(Handle handle, Contact&& contact)
+{
+    PROFILE_SCOPE("store.replace");
+    if (handle >= contacts_.size())
+        return false;
+
+    std::string_view oldEmail = contacts_[handle].getemail();
+    bool emailChanged = contact.getemail() != oldEmail;
+    if (emailChanged && byEmail_.count(contact.getemail()))
+        return false;
+
+    // Re-keyed even when the e-mail is the same: the key must view the bytes of
+    // the new contact, the old ones go away with it.
+    log(JournalOp::Edit, oldEmail, &contact);
+    byEmail_.erase(oldEmail);
+    byEmail_.emplace(contact.getemail(), handle);
+
+    byName_.erase(nameKey(contacts_[handle], handle));
+    byName_.insert(nameKey(contact, handle));
+
+    const Contact& old = contacts_[handle];
+    if (old.getName() != contact.getName() || old.getSurname() != contact.getSurname() ||
+        old.getPatronymic() != contact.getPatronymic())
+    {
+        fuzzy_.erase(handle, old);
+        fuzzy_.insert(handle, contact);
+    }
+
+    byPhone_.erase(handle, old);
+    byPhone_.insert(handle, contact);
+
+    // The new text stays on the same page when it fits there.
+    if (paged_)
+        place(handle, contact, unplace(handle));
+
+    contacts_[handle] = std::move(contact);
+    return true;
+}
+
+ContactStore::Handle ContactStore::findByEmail(std::string_view email) const
+{
+    auto it = byEmail_.find(email);
+    return it == byEmail_.end() ? npos : it->second;
+}
+
+std::size_t ContactStore::visitByName(std::string_view surname, std::string_view name,
+                                      const Visitor& visit, std::size_t limit) const
+{
+    std::size_t count = 0;
+    for (auto it = byName_.lower_bound(NameKey(surname, name, 0));
+         count < limit && it != byName_.end() && std::get<0>(*it) == surname && std::get<1>(*it) == name;
+         ++it)
+    {
+        ++count;
+        if (!visit(std::get<2>(*it), contacts_[std::get<2>(*it)]))
+            break;
+    }
+    return count;
+}
+
+std::size_t ContactStore::visitBySurnamePrefix(std::string_view prefix,
+                                               const Visitor& visit, std::size_t limit) const
+{
+    std::size_t count = 0;
+    for (auto it = byName_.lower_bound(NameKey(prefix, std::string_view(), 0));
+         count < limit && it != byName_.end() && std::get<0>(*it).compare(0, prefix.size(), prefix) == 0;
+         ++it)
+    {
+        ++count;
+        if (!visit(std::get<2>(*it), contacts_[std::get<2>(*it)]))
+            break;
+    }
+    return count;
+}
+
+std::size_t ContactStore::visitBySurnameRange(std::string_view from, std::string_view to,
+                                              const Visitor& visit, std::size_t limit) const
+{
+    std::size_t count = 0;
+    for (auto it = byName_.lower_bound(NameKey(from, std::string_view(), 0));
+         count < limit && it != byName_.end() && std::get<0>(*it) < to;
+         ++it)
+    {
+        ++count;
+        if (!visit(std::get<2>(*it), contacts_[std::get<2>(*it)]))
+            break;
+    }
+    return count;
+}
+
+std::vector<ContactStore::Handle> ContactStore::findByPhone(std::string_view number) const
+{
+    std::uint64_t key;
+    if (!PhoneIndex::key(number, key))
+        return {};
+    return byPhone_.find(key);
+}
+
+bool ContactStore::visitByPhonePrefix(std::string_view prefix, const Visitor& visit, std::size_t limit) const
+{
+    std::uint64_t from, to;
+    if (!PhoneIndex::prefixRange(prefix, from, to))
+        return false;
+
+    byPhone_.visitRange(from, to, [&](Handle h) { return visit(h, contacts_[h]); }, limit);
+    return true;
+}
+
+std::vector<FuzzyIndex::Match> ContactStore::findSimilar(std::string_view query, std::size_t limit) const
+{
+    return fuzzy_.search(query, limit, contacts_);
+}
+
+std::vector<ContactStore::Handle> ContactStore::findByName(std::string_view surname,
+                                                           std::string_view name) const
+{
+    std::vector<Handle> result;
+    visitByName(surname, name, [&](Handle h, const Contact&) { result.push_back(h); return true; });
+    return result;
+}
+
+std::vector<ContactStore::Handle> ContactStore::findBySurnamePrefix(std::string_view prefix) const
+{
+    std::vector<Handle> result;
+    visitBySurnamePrefix(prefix, [&](Handle h, const Contact&) { result.push_back(h); return true; });
+    return result;
+}
+
+std::vector<ContactStore::Handle> ContactStore::findBySurnameRange(std::string_view from,
+                                                                   std::string_view to) const
+{
+    std::vector<Handle> result;
+    visitBySurnameRange(from, to, [&](Handle h, const Contact&) { result.push_back(h); return true; });
+    return result;
+}
+
+ContactStore::NameKey ContactStore::nameKey(const Contact& contact, Handle handle)
+{
+    return NameKey(contact.getSurname(), contact.getName(), handle);
+}
+
+void ContactStore::rebuildIndex(std::vector<RecordSpan>& spans, std::vector<std::string>& rejected)
+{
+    byEmail_.clear();
+    byEmail_.reserve(contacts_.size());
+    byName_.clear();
+
+    // Later records with an already known e-mail are rejected: the first one wins.
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < contacts_.size(); ++i)
+    {
+        if (!byEmail_.emplace(contacts_[i].getemail(), kept).second)
+        {
+            rejected.push_back(formatContactLine(contacts_[i]));
+            continue;
+        }
+
+        if (kept != i)
+        {
+            contacts_[kept] = std::move(contacts_[i]);
+            if (i < spans.size())
+                spans[kept] = spans[i];
+        }
+        ++kept;
+    }
+    contacts_.erase(contacts_.begin() + kept, contacts_.end());
+    if (spans.size() > kept)
+        spans.resize(kept);
+
+    fuzzy_.clear();
+    byPhone_.clear();
+    for (Handle h = 0; h < contacts_.size(); ++h)
+    {
+        byName_.insert(nameKey(contacts_[h], h));
+        fuzzy_.insert(h, contacts_[h]);
+        byPhone_.insert(h, contacts_[h]);
+    }
+}
+
+void ContactStore::buildPages(const std::vector<RecordSpan>& spans, std::uint64_t fileSize)
+{
+    pages_.clear();
+    pageOf_.clear();
+    dirtyPages_.clear();
+    fresh_.clear();
+    fileSize_  = fileSize;
+    liveBytes_ = 0;
+    paged_     = false;
+
+    if (fileSize == 0 || fileSize % kRecordPageSize != 0 || spans.size() != contacts_.size())
+        return;
+
+    // Records come in file order. A page is the run of blocks from the one a
+    // record starts in to the one holding its newline; a later record starting
+    // inside that run must also end there, or the file is not paged.
+    pageOf_.resize(contacts_.size());
+    for (Handle h = 0; h < spans.size(); ++h)
+    {
+        const RecordSpan& span = spans[h];
+        std::uint64_t newline = span.offset + span.length;
+        if (newline >= fileSize)
+            break;
+
+        std::uint64_t firstBlock = span.offset / kRecordPageSize;
+        std::uint64_t lastBlock  = newline / kRecordPageSize;
+
+        bool samePage = !pages_.empty() && span.offset < pages_.back().offset + pages_.back().capacity;
+        if (samePage && newline >= pages_.back().offset + pages_.back().capacity)
+            break;
+
+        if (!samePage)
+        {
+            Page page;
+            page.offset   = firstBlock * kRecordPageSize;
+            page.capacity = static_cast<std::uint32_t>((lastBlock - firstBlock + 1) * kRecordPageSize);
+            pages_.push_back(std::move(page));
+        }
+
+        Page& page = pages_.back();
+        std::uint32_t length = span.length + 1;
+        page.slots.push_back(Slot{ h, static_cast<std::uint32_t>(span.offset - page.offset), length });
+        page.used  += length;
+        liveBytes_ += length;
+        pageOf_[h]  = static_cast<std::uint32_t>(pages_.size() - 1);
+
+        if (h + 1 == spans.size())
+            paged_ = true;
+    }
+
+    if (!paged_)
+    {
+        pages_.clear();
+        pageOf_.clear();
+        liveBytes_ = 0;
+    }
+}
+
+void ContactStore::place(Handle handle, const Contact& contact, std::uint32_t preferred)
+{
+    std::string text = formatContactLine(contact);
+    std::uint32_t length = static_cast<std::uint32_t>(text.size() + 1);
+
+    auto fits = [&](std::uint32_t p) { return p < pages_.size() && pages_[p].used + length <= pages_[p].capacity; };
+
+    std::uint32_t p = preferred;
+    if (!fits(p))
+        p = static_cast<std::uint32_t>(pages_.size() - 1);
+    if (pages_.empty() || !fits(p))
+    {
+        Page page;
+        page.offset   = fileSize_;
+        page.capacity = static_cast<std::uint32_t>((length + kRecordPageSize - 1) / kRecordPageSize * kRecordPageSize);
+        fileSize_    += page.capacity;
+        pages_.push_back(std::move(page));
+        p = static_cast<std::uint32_t>(pages_.size() - 1);
+    }
+
+    pages_[p].slots.push_back(Slot{ handle, kFresh, length });
+    pages_[p].used += length;
+    liveBytes_     += length;
+    pageOf_[handle] = p;
+    fresh_[handle]  = std::move(text);
+    markDirty(p);
+}
+
+std::uint32_t ContactStore::unplace(Handle handle)
+{
+    std::uint32_t p = pageOf_[handle];
+    std::vector<Slot>& slots = pages_[p].slots;
+    auto it = std::find_if(slots.begin(), slots.end(), [&](const Slot& s) { return s.handle == handle; });
+
+    pages_[p].used -= it->length;
+    liveBytes_     -= it->length;
+    slots.erase(it);
+    fresh_.erase(handle);
+    markDirty(p);
+    return p;
+}
+
+void ContactStore::rekey(Handle from, Handle to)
+{
+    std::uint32_t p = pageOf_[from];
+    for (Slot& s : pages_[p].slots)
+    {
+        if (s.handle == from)
+            s.handle = to;
+    }
+    pageOf_[to] = p;
+
+    auto node = fresh_.extract(from);
+    if (!node.empty())
+    {
+        node.key() = to;
+        fresh_.insert(std::move(node));
+    }
+}
+
+void ContactStore::markDirty(std::uint32_t page)
+{
+    if (!pages_[page].dirty)
+    {
+        pages_[page].dirty = true;
+        dirtyPages_.push_back(page);
+    }
+}
+
+bool ContactStore::writeDirtyPages()
+{
+    if (dirtyPages_.empty())
+        return true;
+
+    std::sort(dirtyPages_.begin(), dirtyPages_.end());
+
+    std::ifstream in(filename_, std::ios::binary);
+    std::vector<PageImage> images;
+    images.reserve(dirtyPages_.size());
+
+    std::string old;
+    for (std::uint32_t p : dirtyPages_)
+    {
+        const Page& page = pages_[p];
+        PageImage image{ page.offset, std::string() };
+        image.bytes.reserve(page.capacity);
+
+        // Records that did not change are copied from the page as it is on disk.
+        bool needOld = std::any_of(page.slots.begin(), page.slots.end(), [](const Slot& s) { return s.offset != kFresh; });
+        if (needOld)
+        {
+            old.resize(page.capacity);
+            in.seekg(static_cast<std::streamoff>(page.offset));
+            if (!in.read(&old[0], static_cast<std::streamsize>(old.size())))
+                return false;
+        }
+
+        for (const Slot& s : page.slots)
+        {
+            if (s.offset == kFresh)
+                image.bytes.append(fresh_[s.handle]) += '\n';
+            else
+                image.bytes.append(old, s.offset, s.length);
+        }
+        image.bytes.resize(page.capacity, '\n');
+        images.push_back(std::move(image));
+    }
+    in.close();
+
+    if (!writePages(filename_, images))
+        return false;
+
+    // Every record of a written page now sits where the image put it.
+    for (std::uint32_t p : dirtyPages_)
+    {
+        Page& page = pages_[p];
+        std::uint32_t offset = 0;
+        for (Slot& s : page.slots)
+        {
+            if (s.offset == kFresh)
+                fresh_.erase(s.handle);
+            s.offset = offset;
+            offset  += s.length;
+        }
+        page.dirty = false;
+    }
+    dirtyPages_.clear();
+    return true;
+}
+
+bool ContactStore::rewriteFile()
+{
+    if (snapshot_)
+        return saveSnapshot(filename_, contacts_);
+
+    std::vector<RecordSpan> spans;
+    if (!saveContactsPaged(filename_, contacts_, spans))
+        return false;
+
+    std::error_code ec;
+    std::uint64_t fileSize = std::filesystem::file_size(filename_, ec);
+    buildPages(spans, ec ? 0 : fileSize);
+    return true;
+}
+
+void ContactStore::replay(const std::vector<JournalEntry>& entries)
+{
+    // Entries are applied as upserts and tolerant deletes, so replaying a journal
+    // whose changes already reached the snapshot leaves the store unchanged.
+    for (const JournalEntry& e : entries)
+    {
+        if (e.op == JournalOp::Delete)
+        {
+            Handle h = findByEmail(e.key);
+            if (h != npos)
+                remove(h);
+            continue;
+        }
+
+        std::optional<Contact> c = parseContactLine(e.record);
+        if (!c)
+            continue;
+
+        Handle h = e.op == JournalOp::Edit ? findByEmail(e.key) : npos;
+        if (h == npos)
+            h = findByEmail(c->getemail());
+
+        if (h == npos)
+            add(std::move(*c));
+        else
+            replace(h, std::move(*c));
+    }
+}
+
+void ContactStore::log(JournalOp op, std::string_view key, const Contact* contact)
+{
+    if (filename_.empty())
+        return;
+
+    pending_.push_back(JournalEntry{ op, std::string(key), contact ? formatContactLine(*contact) : std::string() });
+}
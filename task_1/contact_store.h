@@ -0,0 +1,171 @@
+#ifndef CONTACT_STORE_H
+#define CONTACT_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Contact_class.h"
+#include "contact_storage.h"
+#include "fuzzy_index.h"
+#include "phone_index.h"
+
+// Owns the loaded contacts and keeps the lookup indexes in sync with them.
+// A Handle is a slot in contacts(); it stays valid until the next remove().
+//
+// remove() moves the last contact into the freed slot, so it takes O(1) but
+// does not keep the order: after removing B from A, B, C, D the contacts are
+// A, D, C. Listings, exports and a whole rewrite of the contacts file follow
+// that order, unlike the erase of the original program. Compacting a paged
+// text file leaves the remaining records where they are on disk.
+// E-mails are unique inside the store. Index keys are views into the pooled
+// strings of the contacts they index and are replaced together with them.
+//
+// Mutations are logged and written to "<file>.journal" by commit(); once the
+// journal grows long enough it is folded into the contacts file by compact().
+//
+// Records open() cannot take, a second record with an e-mail already loaded
+// or one with a phone number that cannot be stored, are appended as they are to "<file>.rejected" and the contacts file
+// is rewritten without them; rejected() tells the caller how many there were.
+//
+// A contacts file that is a binary snapshot (see contact_snapshot.h) stays one:
+// compact() writes it again as a whole snapshot.
+//
+// A text contacts file is kept in the paged layout of saveContactsPaged(). The
+// store knows which page holds every contact and marks a record dirty when it
+// is added or changed and its page dirty when a record leaves it, so compact()
+// rewrites only the dirty pages. Unchanged records on such a page are copied
+// from the page as it is on disk instead of being formatted again. A file that
+// is not paged yet (or has become mostly padding) is rewritten whole once.
+class ContactStore
+{
+public:
+    using Handle = std::size_t;
+    static constexpr Handle npos = static_cast<Handle>(-1);
+
+    // False if the file or its journal cannot be read. No file is bound then, so
+    // the store must not be used for edits until an open() succeeds.
+    bool open   (const std::string& filename);
+    bool commit ();
+    bool compact();
+
+    bool   add         (const Contact& contact);
+    bool   add         (Contact&&      contact);
+    bool   remove      (Handle handle);
+    bool   replace     (Handle handle, const Contact& contact);
+    bool   replace     (Handle handle, Contact&&      contact);
+    Handle findByEmail (std::string_view email) const;
+
+    std::size_t rejected()     const noexcept { return rejected_; }
+    std::string rejectedName() const { return filename_ + ".rejected"; }
+
+    // Builds the contact in place from Contact constructor arguments. Like
+    // add(), false and nothing stored if its e-mail is already taken.
+    template <typename... Args>
+    bool emplace(Args&&... args)
+    {
+        contacts_.emplace_back(std::forward<Args>(args)...);
+        return indexAdded();
+    }
+
+    // Called for each match in turn; returning false stops the walk.
+    using Visitor = std::function<bool(Handle, const Contact&)>;
+
+    // Streaming name lookups: walk the (surname, name) index in order and hand
+    // each match to visit, nothing is copied. At most limit matches are visited;
+    // the return value is how many were.
+    std::size_t visitByName          (std::string_view surname, std::string_view name,
+                                      const Visitor& visit, std::size_t limit = npos) const;
+    std::size_t visitBySurnamePrefix (std::string_view prefix,
+                                      const Visitor& visit, std::size_t limit = npos) const;
+    std::size_t visitBySurnameRange  (std::string_view from, std::string_view to,
+                                      const Visitor& visit, std::size_t limit = npos) const;
+
+    // Contacts having the number, in any accepted notation; see PhoneIndex::key().
+    std::vector<Handle> findByPhone(std::string_view number) const;
+
+    // Contacts with a number starting with prefix (area code first, see
+    // PhoneIndex::prefixRange()), in number order. False if prefix is not a
+    // digit prefix.
+    bool visitByPhonePrefix(std::string_view prefix, const Visitor& visit, std::size_t limit = npos) const;
+
+    // Typo-tolerant lookup by name words, best matches first; see FuzzyIndex.
+    std::vector<FuzzyIndex::Match> findSimilar(std::string_view query, std::size_t limit) const;
+
+    // Same lookups collected into a list of handles.
+    std::vector<Handle> findByName          (std::string_view surname, std::string_view name) const;
+    std::vector<Handle> findBySurnamePrefix (std::string_view prefix) const;
+    std::vector<Handle> findBySurnameRange  (std::string_view from, std::string_view to) const;
+
+    const Contact&              at(Handle handle) const { return contacts_[handle]; }
+    const std::vector<Contact>& contacts()        const noexcept { return contacts_; }
+    std::size_t                 size()            const noexcept { return contacts_.size(); }
+    bool                        empty()           const noexcept { return contacts_.empty(); }
+
+private:
+    using NameKey = std::tuple<std::string_view, std::string_view, Handle>;
+
+    static NameKey nameKey(const Contact& contact, Handle handle);
+
+    // A record on a page: its handle and where its line sits in the page image
+    // on disk, newline included. kFresh marks a record whose text waits in fresh_.
+    struct Slot
+    {
+        Handle        handle;
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+    static constexpr std::uint32_t kFresh = static_cast<std::uint32_t>(-1);
+
+    struct Page
+    {
+        std::uint64_t     offset   = 0;
+        std::uint32_t     capacity = 0;
+        std::uint32_t     used     = 0;
+        bool              dirty    = false;
+        std::vector<Slot> slots;
+    };
+
+    bool indexAdded  ();
+    void rebuildIndex(std::vector<RecordSpan>& spans, std::vector<std::string>& rejected);
+    void buildPages  (const std::vector<RecordSpan>& spans, std::uint64_t fileSize);
+    void place       (Handle handle, const Contact& contact, std::uint32_t preferred);
+    std::uint32_t unplace(Handle handle);
+    void rekey       (Handle from, Handle to);
+    void markDirty   (std::uint32_t page);
+    bool writeDirtyPages();
+    bool rewriteFile ();
+    bool compact     (bool repack);
+    void replay(const std::vector<JournalEntry>& entries);
+    void log   (JournalOp op, std::string_view key, const Contact* contact);
+
+    std::string journalName() const { return filename_ + ".journal"; }
+
+    std::string                                  filename_;
+    std::vector<JournalEntry>                    pending_;
+    std::size_t                                  journalSize_ = 0;
+    std::size_t                                  rejected_    = 0;
+
+    std::vector<Contact>                         contacts_;
+    std::unordered_map<std::string_view, Handle> byEmail_;
+    std::set<NameKey>                            byName_;
+    FuzzyIndex                                   fuzzy_;
+    PhoneIndex                                   byPhone_;
+
+    bool                                         snapshot_  = false;
+    bool                                         paged_     = false;
+    std::uint64_t                                fileSize_  = 0;
+    std::uint64_t                                liveBytes_ = 0;
+    std::vector<Page>                            pages_;
+    std::vector<std::uint32_t>                   pageOf_;
+    std::vector<std::uint32_t>                   dirtyPages_;
+    std::unordered_map<Handle, std::string>      fresh_;
+};
+
+#endif // CONTACT_STORE_H
@@ -0,0 +1,118 @@
+#include "contact_table.h"
+
+#include <cstring>
+
+void ContactTable::StringColumn::append(std::string_view value)
+{
+    bytes.append(value.data(), value.size());
+    offsets.push_back(bytes.size());
+}
+
+std::string_view ContactTable::StringColumn::at(Row r) const
+{
+    return std::string_view(bytes).substr(static_cast<std::size_t>(offsets[r]),
+                                          static_cast<std::size_t>(offsets[r + 1] - offsets[r]));
+}
+
+std::vector<ContactTable::Row> ContactTable::StringColumn::findEqual(std::string_view value) const
+{
+    std::vector<Row> rows;
+    const char* base = bytes.data();
+
+    // Lengths come from the offsets array alone; bytes are only read for candidates of the right length.
+    for (Row r = 0; r + 1 < offsets.size(); ++r)
+    {
+        std::uint64_t begin = offsets[r];
+        if (offsets[r + 1] - begin == value.size() &&
+            std::memcmp(base + begin, value.data(), value.size()) == 0)
+        {
+            rows.push_back(r);
+        }
+    }
+    return rows;
+}
+
+std::uint32_t ContactTable::packDate(const Contact::Date& d)
+{
+    return (static_cast<std::uint32_t>(d.year) << 9) |
+           (static_cast<std::uint32_t>(d.month) << 5) |
+            static_cast<std::uint32_t>(d.day);
+}
+
+Contact::Date ContactTable::unpackDate(std::uint32_t packed)
+{
+    Contact::Date d{};
+    d.day   = static_cast<int>(packed & 31);
+    d.month = static_cast<int>((packed >> 5) & 15);
+    d.year  = static_cast<int>(packed >> 9);
+    return d;
+}
+
+ContactTable ContactTable::fromContacts(const std::vector<Contact>& contacts)
+{
+    ContactTable table;
+    table.births_.reserve(contacts.size());
+    table.phoneOffsets_.reserve(contacts.size() + 1);
+
+    for (const Contact& c : contacts)
+        table.append(c);
+    return table;
+}
+
+std::vector<Contact> ContactTable::toContacts() const
+{
+    std::vector<Contact> contacts;
+    contacts.reserve(size());
+
+    for (Row r = 0; r < size(); ++r)
+        contacts.push_back(row(r));
+    return contacts;
+}
+
+void ContactTable::append(const Contact& contact)
+{
+    names_.append(contact.getName());
+    surnames_.append(contact.getSurname());
+    patronymics_.append(contact.getPatronymic());
+    emails_.append(contact.getemail());
+    addresses_.append(contact.getAddress());
+
+    births_.push_back(packDate(contact.getBirth_date()));
+
+    for (const Contact::PackedPhone& p : contact.getPhones())
+        phones_.push_back(p);
+    phoneOffsets_.push_back(static_cast<std::uint32_t>(phones_.size()));
+}
+
+Contact ContactTable::row(Row r) const
+{
+    Contact::PhoneList phones;
+    for (std::uint32_t i = phoneOffsets_[r]; i < phoneOffsets_[r + 1]; ++i)
+        phones.push_back(phones_[i]);
+
+    return Contact(name(r), surname(r), patronymic(r), email(r), address(r), birthDate(r), phones);
+}
+
+std::vector<ContactTable::Row> ContactTable::findBySurname(std::string_view surname) const
+{
+    return surnames_.findEqual(surname);
+}
+
+std::vector<ContactTable::Row> ContactTable::findByEmail(std::string_view email) const
+{
+    return emails_.findEqual(email);
+}
+
+std::vector<ContactTable::Row> ContactTable::bornBetween(const Contact::Date& from, const Contact::Date& to) const
+{
+    std::uint32_t lo = packDate(from);
+    std::uint32_t hi = packDate(to);
+
+    std::vector<Row> rows;
+    for (Row r = 0; r < births_.size(); ++r)
+    {
+        if (births_[r] >= lo && births_[r] <= hi)
+            rows.push_back(r);
+    }
+    return rows;
+}
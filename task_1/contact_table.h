@@ -0,0 +1,68 @@
+#ifndef CONTACT_TABLE_H
+#define CONTACT_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Contact_class.h"
+
+// Column-wise copy of a contact list for scans and analytics. Every field is
+// kept in its own contiguous array, so a filter on one column reads only that
+// column's bytes instead of whole Contact objects. Rows keep the order of the
+// list they were built from.
+class ContactTable
+{
+public:
+    using Row = std::size_t;
+
+    static ContactTable fromContacts(const std::vector<Contact>& contacts);
+    std::vector<Contact> toContacts() const;
+
+    void    append(const Contact& contact);
+    Contact row   (Row r) const;
+
+    std::size_t size()  const noexcept { return births_.size(); }
+    bool        empty() const noexcept { return births_.empty(); }
+
+    std::string_view name      (Row r) const { return names_.at(r); }
+    std::string_view surname   (Row r) const { return surnames_.at(r); }
+    std::string_view patronymic(Row r) const { return patronymics_.at(r); }
+    std::string_view email     (Row r) const { return emails_.at(r); }
+    std::string_view address   (Row r) const { return addresses_.at(r); }
+    Contact::Date    birthDate (Row r) const { return unpackDate(births_[r]); }
+
+    // Full-column filters; each returns the matching rows in order.
+    std::vector<Row> findBySurname(std::string_view surname) const;
+    std::vector<Row> findByEmail  (std::string_view email) const;
+    std::vector<Row> bornBetween  (const Contact::Date& from, const Contact::Date& to) const;
+
+private:
+    // All values of one text field back to back; value i is [offsets[i], offsets[i + 1]).
+    struct StringColumn
+    {
+        std::string                bytes;
+        std::vector<std::uint64_t> offsets{0};
+
+        void             append(std::string_view value);
+        std::string_view at(Row r) const;
+        std::vector<Row> findEqual(std::string_view value) const;
+    };
+
+    // Dates are packed as year << 9 | month << 5 | day, so they compare as integers.
+    static std::uint32_t packDate  (const Contact::Date& d);
+    static Contact::Date unpackDate(std::uint32_t packed);
+
+    StringColumn names_;
+    StringColumn surnames_;
+    StringColumn patronymics_;
+    StringColumn emails_;
+    StringColumn addresses_;
+
+    std::vector<std::uint32_t>        births_;
+    std::vector<std::uint32_t>        phoneOffsets_{0};
+    std::vector<Contact::PackedPhone> phones_;
+};
+
+#endif // CONTACT_TABLE_H
@@ -0,0 +1,94 @@
+#include "contact_tests.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct Entry
+    {
+        const char*     name;
+        tests::Function function;
+    };
+
+    std::vector<Entry>& registry()
+    {
+        static std::vector<Entry> entries;
+        return entries;
+    }
+
+    std::size_t failures = 0;
+
+    bool selected(const char* name, int argc, char** argv)
+    {
+        if (argc < 2)
+            return true;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strstr(name, argv[i]))
+                return true;
+        }
+        return false;
+    }
+}
+
+namespace tests
+{
+    Registrar::Registrar(const char* name, Function function)
+    {
+        registry().push_back(Entry{ name, function });
+    }
+
+    void fail(const char* file, int line, const std::string& message)
+    {
+        ++failures;
+        std::cout << "  " << file << ':' << line << ": " << message << '\n';
+    }
+
+    TempDir::TempDir(const std::string& name)
+        : path_((std::filesystem::temp_directory_path() / ("contact_tests_" + name)).string())
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+        std::filesystem::create_directories(path_);
+    }
+
+    TempDir::~TempDir()
+    {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path_, ec))
+            std::filesystem::permissions(entry.path(), std::filesystem::perms::owner_all, ec);
+        std::filesystem::remove_all(path_, ec);
+    }
+
+    std::string TempDir::file(const std::string& name) const
+    {
+        return (std::filesystem::path(path_) / name).string();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t run = 0, failed = 0;
+    for (const Entry& e : registry())
+    {
+        if (!selected(e.name, argc, argv))
+            continue;
+
+        std::cout << e.name << '\n';
+        std::size_t before = failures;
+        e.function();
+        ++run;
+        if (failures != before)
+        {
+            ++failed;
+            std::cout << "  FAILED\n";
+        }
+    }
+
+    std::cout << run << " tests, " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#ifndef CONTACT_TESTS_H
+#define CONTACT_TESTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// A small self-registering harness for the contact_tests target (tests.pro):
+//
+//   TEST(dates_round_trip)
+//   {
+//       CHECK(parseDate("01.02.2003", d));
+//       CHECK_EQ(d.year, 2003);
+//   }
+//
+// A failed check is reported with its file and line and the test goes on. The
+// run exits non-zero if any check failed. Arguments select the tests whose
+// names contain one of them.
+
+namespace tests
+{
+    using Function = void (*)();
+
+    struct Registrar
+    {
+        Registrar(const char* name, Function function);
+    };
+
+    void fail(const char* file, int line, const std::string& message);
+
+    // Deterministic generator for randomized tests, so a failure can be reproduced.
+    class Random
+    {
+    public:
+        explicit Random(std::uint64_t seed) : state_(seed) {}
+
+        std::uint64_t next()
+        {
+            std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        std::size_t below(std::size_t n) { return static_cast<std::size_t>(next() % n); }
+
+    private:
+        std::uint64_t state_;
+    };
+
+    // A fresh directory under the system temp directory, removed with all it
+    // holds (whatever its permissions) when the test is done.
+    class TempDir
+    {
+    public:
+        explicit TempDir(const std::string& name);
+        ~TempDir();
+
+        TempDir(const TempDir&)            = delete;
+        TempDir& operator=(const TempDir&) = delete;
+
+        std::string file(const std::string& name) const;
+
+    private:
+        std::string path_;
+    };
+
+    template <typename A, typename B>
+    void checkEqual(const A& a, const B& b, const char* text, const char* file, int line)
+    {
+        if (a == b)
+            return;
+
+        std::ostringstream os;
+        os << text << ": " << a << " != " << b;
+        fail(file, line, os.str());
+    }
+}
+
+#define TEST(name)                                                        \
+    static void name();                                                   \
+    static const ::tests::Registrar name##Registrar_(#name, &name);       \
+    static void name()
+
+#define CHECK(expr)                                                       \
+    do {                                                                  \
+        if (!(expr))                                                      \
+            ::tests::fail(__FILE__, __LINE__, #expr);                     \
+    } while (false)
+
+#define CHECK_EQ(a, b) ::tests::checkEqual((a), (b), #a " == " #b, __FILE__, __LINE__)
+
+#endif // CONTACT_TESTS_H
@@ -0,0 +1,108 @@
+#include "contact_writer.h"
+#include "contact_codec.h"
+#include "contact_storage.h"
+
+#include <charconv>
+
+namespace
+{
+    void appendNumber(std::string& out, unsigned long long value)
+    {
+        char digits[24];
+        auto res = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, static_cast<std::size_t>(res.ptr - digits));
+    }
+
+    void appendNumber(std::string& out, int value)
+    {
+        char digits[16];
+        auto res = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, static_cast<std::size_t>(res.ptr - digits));
+    }
+}
+
+ContactWriter::ContactWriter(std::ostream& os)
+    : os_(os)
+{
+    buffer_.reserve(kWriteChunk + kWriteChunk / 4);
+}
+
+ContactWriter::~ContactWriter()
+{
+    flush();
+}
+
+void ContactWriter::text(std::string_view text)
+{
+    buffer_.append(text.data(), text.size());
+    flushIfFull();
+}
+
+void ContactWriter::card(const Contact& c, std::size_t number)
+{
+    const Contact::Date& d = c.getBirth_date();
+
+    buffer_ += "\n#";
+    appendNumber(buffer_, static_cast<unsigned long long>(number));
+    buffer_ += '\n';
+
+    buffer_.append("Name:      ").append(c.getName())    += '\n';
+    buffer_.append("Surname:   ").append(c.getSurname()) += '\n';
+
+    if (!c.getPatronymic().empty())
+        buffer_.append("Patronymic:").append(c.getPatronymic()) += '\n';
+
+    if (!c.getAddress().empty())
+        buffer_.append("Address:   ").append(c.getAddress()) += '\n';
+
+    buffer_ += "Birthdate: ";
+    appendNumber(buffer_, d.day);
+    buffer_ += '.';
+    appendNumber(buffer_, d.month);
+    buffer_ += '.';
+    appendNumber(buffer_, d.year);
+    buffer_ += '\n';
+
+    buffer_.append("Email:     ").append(c.getemail()) += '\n';
+
+    const auto& phones = c.getPhones();
+    if (!phones.empty())
+    {
+        buffer_ += "Phones:\n";
+
+        char number[Contact::PackedPhone::kMaxLength];
+        for (const auto& p : phones)
+        {
+            buffer_.append("  - [").append(phoneTypeName(p.type())) += "] ";
+            buffer_.append(number, p.format(number)) += '\n';
+        }
+    }
+
+    flushIfFull();
+}
+
+void ContactWriter::record(const Contact& contact)
+{
+    appendContactLine(buffer_, contact);
+    buffer_ += '\n';
+    flushIfFull();
+}
+
+void ContactWriter::flush()
+{
+    if (!buffer_.empty())
+    {
+        os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+    os_.flush();
+}
+
+void ContactWriter::flushIfFull()
+{
+    if (buffer_.size() >= kWriteChunk)
+    {
+        os_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+}
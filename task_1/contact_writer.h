@@ -0,0 +1,43 @@
+#ifndef CONTACT_WRITER_H
+#define CONTACT_WRITER_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "Contact_class.h"
+
+// Buffered output is handed to the stream in pieces of about this size, here
+// and by saveContacts().
+constexpr std::size_t kWriteChunk = 1 << 16;
+
+// Formats contacts into one reused buffer and hands it to the stream in large
+// chunks, so listing or exporting many contacts costs a few writes instead of
+// a flush per line. Whatever is still buffered is written out on destruction.
+class ContactWriter
+{
+public:
+    explicit ContactWriter(std::ostream& os);
+    ~ContactWriter();
+
+    ContactWriter(const ContactWriter&)            = delete;
+    ContactWriter& operator=(const ContactWriter&) = delete;
+
+    void text  (std::string_view text);
+
+    // Card as shown in the menu listing, headed by "#number".
+    void card  (const Contact& contact, std::size_t number);
+
+    // One contacts.txt record with its newline.
+    void record(const Contact& contact);
+
+    void flush();
+
+private:
+    void flushIfFull();
+
+    std::ostream& os_;
+    std::string   buffer_;
+};
+
+#endif // CONTACT_WRITER_H
@@ -0,0 +1,245 @@
+#include "field_scan.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FIELD_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    bool isEmailChar(char c)
+    {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '.' || c == '@';
+    }
+
+    bool isPhoneChar(char c)
+    {
+        return (c >= '0' && c <= '9') || c == '+' || c == '(' || c == ')' || c == '-';
+    }
+
+    // Continues a record scan from offset i; also the whole scalar implementation.
+    RecordSplit finishScan(const char* p, std::size_t n, std::size_t i, RecordSplit r)
+    {
+        for (; i < n; ++i)
+        {
+            char c = p[i];
+            if (c == '\n')
+                break;
+            if (c == '|' && r.barCount < RecordSplit::kMaxBars)
+                r.bars[r.barCount++] = i;
+        }
+        r.length = i;
+        return r;
+    }
+
+    // Consumes the separator and newline masks of one block starting at offset i.
+    // Returns true once the end of the record has been found.
+    bool takeBlock(const char* p, std::size_t n, std::size_t i, std::size_t width,
+                   std::uint32_t bars, std::uint32_t newlines, RecordSplit& r)
+    {
+        if (newlines)
+            bars &= (newlines & (0u - newlines)) - 1;
+
+        while (bars && r.barCount < RecordSplit::kMaxBars)
+        {
+            r.bars[r.barCount++] = i + static_cast<std::size_t>(__builtin_ctz(bars));
+            bars &= bars - 1;
+        }
+
+        if (newlines)
+        {
+            r.length = i + static_cast<std::size_t>(__builtin_ctz(newlines));
+            return true;
+        }
+
+        if (r.barCount == RecordSplit::kMaxBars)
+        {
+            // Only the newline matters from here on.
+            const void* eol = std::memchr(p + i + width, '\n', n - i - width);
+            r.length = eol ? static_cast<std::size_t>(static_cast<const char*>(eol) - p) : n;
+            return true;
+        }
+        return false;
+    }
+
+    RecordSplit scanRecordScalar(const char* p, std::size_t n)
+    {
+        return finishScan(p, n, 0, RecordSplit{});
+    }
+
+    template <bool (*IsMember)(char)>
+    bool charsetScalar(const char* p, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            if (!IsMember(p[i]))
+                return false;
+        return true;
+    }
+
+#ifdef FIELD_SCAN_X86
+
+    __attribute__((target("sse2")))
+    RecordSplit scanRecordSse2(const char* p, std::size_t n)
+    {
+        const __m128i nl  = _mm_set1_epi8('\n');
+        const __m128i bar = _mm_set1_epi8('|');
+
+        RecordSplit r;
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            auto bars     = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, bar)));
+            auto newlines = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)));
+            if (takeBlock(p, n, i, 16, bars, newlines, r))
+                return r;
+        }
+        return finishScan(p, n, i, r);
+    }
+
+    __attribute__((target("sse2")))
+    inline __m128i inRangeSse2(__m128i v, char lo, char hi)
+    {
+        // Signed compares: bytes >= 0x80 are negative and fall outside every range.
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                             _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(hi + 1)), v));
+    }
+
+    __attribute__((target("sse2")))
+    bool isEmailCharsetSse2(const char* p, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i ok = _mm_or_si128(_mm_or_si128(inRangeSse2(v, 'a', 'z'), inRangeSse2(v, 'A', 'Z')),
+                                      _mm_or_si128(inRangeSse2(v, '0', '9'),
+                                                   _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')),
+                                                                _mm_cmpeq_epi8(v, _mm_set1_epi8('@')))));
+            if (_mm_movemask_epi8(ok) != 0xFFFF)
+                return false;
+        }
+        return charsetScalar<isEmailChar>(p + i, n - i);
+    }
+
+    __attribute__((target("sse2")))
+    bool isPhoneCharsetSse2(const char* p, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i ok = _mm_or_si128(_mm_or_si128(inRangeSse2(v, '0', '9'), inRangeSse2(v, '(', ')')),
+                                      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('+')),
+                                                   _mm_cmpeq_epi8(v, _mm_set1_epi8('-'))));
+            if (_mm_movemask_epi8(ok) != 0xFFFF)
+                return false;
+        }
+        return charsetScalar<isPhoneChar>(p + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    RecordSplit scanRecordAvx2(const char* p, std::size_t n)
+    {
+        const __m256i nl  = _mm256_set1_epi8('\n');
+        const __m256i bar = _mm256_set1_epi8('|');
+
+        RecordSplit r;
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            auto bars     = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, bar)));
+            auto newlines = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl)));
+            if (takeBlock(p, n, i, 32, bars, newlines, r))
+                return r;
+        }
+        return finishScan(p, n, i, r);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i inRangeAvx2(__m256i v, char lo, char hi)
+    {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+    }
+
+    __attribute__((target("avx2")))
+    bool isEmailCharsetAvx2(const char* p, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            __m256i ok = _mm256_or_si256(_mm256_or_si256(inRangeAvx2(v, 'a', 'z'), inRangeAvx2(v, 'A', 'Z')),
+                                         _mm256_or_si256(inRangeAvx2(v, '0', '9'),
+                                                         _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')),
+                                                                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8('@')))));
+            if (static_cast<std::uint32_t>(_mm256_movemask_epi8(ok)) != 0xFFFFFFFFu)
+                return false;
+        }
+        return isEmailCharsetSse2(p + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    bool isPhoneCharsetAvx2(const char* p, std::size_t n)
+    {
+        std::size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            __m256i ok = _mm256_or_si256(_mm256_or_si256(inRangeAvx2(v, '0', '9'), inRangeAvx2(v, '(', ')')),
+                                         _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('+')),
+                                                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-'))));
+            if (static_cast<std::uint32_t>(_mm256_movemask_epi8(ok)) != 0xFFFFFFFFu)
+                return false;
+        }
+        return isPhoneCharsetSse2(p + i, n - i);
+    }
+
+#endif // FIELD_SCAN_X86
+
+    const FieldScanKernels& kernels()
+    {
+        static const FieldScanKernels k = fieldScanKernels().front();
+        return k;
+    }
+}
+
+std::vector<FieldScanKernels> fieldScanKernels()
+{
+    std::vector<FieldScanKernels> all;
+#ifdef FIELD_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        all.push_back({ scanRecordAvx2, isEmailCharsetAvx2, isPhoneCharsetAvx2, "avx2" });
+    if (__builtin_cpu_supports("sse2"))
+        all.push_back({ scanRecordSse2, isEmailCharsetSse2, isPhoneCharsetSse2, "sse2" });
+#endif
+    all.push_back({ scanRecordScalar, charsetScalar<isEmailChar>, charsetScalar<isPhoneChar>, "scalar" });
+    return all;
+}
+
+RecordSplit scanRecord(std::string_view text)
+{
+    return kernels().scanRecord(text.data(), text.size());
+}
+
+bool isEmailCharset(std::string_view text)
+{
+    return kernels().isEmailCharset(text.data(), text.size());
+}
+
+bool isPhoneCharset(std::string_view text)
+{
+    return kernels().isPhoneCharset(text.data(), text.size());
+}
+
+const char* fieldScanImplementation()
+{
+    return kernels().name;
+}
@@ -0,0 +1,47 @@
+#ifndef FIELD_SCAN_H
+#define FIELD_SCAN_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Vectorized scanning kernels for bulk import. Each entry point picks an AVX2,
+// SSE2 or scalar implementation once, from the features of the running CPU;
+// all of them return exactly the same results.
+
+// Where the '|' separators of one record are. The record ends at the first
+// '\n' or at the end of the text; only the first kMaxBars separators are kept.
+struct RecordSplit
+{
+    static constexpr std::size_t kMaxBars = 6;
+
+    std::size_t length   = 0;
+    std::size_t barCount = 0;
+    std::size_t bars[kMaxBars]{};
+};
+
+RecordSplit scanRecord(std::string_view text);
+
+// True when every byte is in the character set of a valid e-mail (ASCII
+// letters, digits, '.', '@') or of a valid phone number (digits, '+', '(', ')', '-').
+// Used as a fast reject in front of the exact validators.
+bool isEmailCharset(std::string_view text);
+bool isPhoneCharset(std::string_view text);
+
+// Name of the implementation chosen for this CPU: "avx2", "sse2" or "scalar".
+const char* fieldScanImplementation();
+
+// One implementation of the kernels above, so they can be compared.
+struct FieldScanKernels
+{
+    RecordSplit (*scanRecord)(const char*, std::size_t);
+    bool        (*isEmailCharset)(const char*, std::size_t);
+    bool        (*isPhoneCharset)(const char*, std::size_t);
+    const char*  name;
+};
+
+// Every implementation the running CPU supports, the chosen one first and the
+// scalar one last.
+std::vector<FieldScanKernels> fieldScanKernels();
+
+#endif // FIELD_SCAN_H
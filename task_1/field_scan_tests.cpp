@@ -0,0 +1,96 @@
+#include "contact_tests.h"
+#include "field_scan.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Every vectorized kernel the CPU can run against the scalar one, on random
+// records and fields. Lengths cross the 16- and 32-byte blocks, inputs start
+// at every alignment, and bytes sit on both sides of each character range,
+// including the ones above 0x7F that signed compares could let through.
+
+namespace
+{
+    const char kRecordBytes[] = "||||\n\nab09@.+()- xZ";
+    const char kEdges[] = { 0, '\t', ' ', '\'', '*', ',', '/', ':', '?', '[', '`', '{', '\x7F',
+                            '\x80', '\xA0', '\xC0', '\xFF' };
+
+    std::string randomRecord(tests::Random& random)
+    {
+        std::string text(random.below(200), ' ');
+        for (char& c : text)
+            c = random.below(8) == 0 ? kEdges[random.below(sizeof kEdges)]
+                                     : kRecordBytes[random.below(sizeof kRecordBytes - 1)];
+        return text;
+    }
+
+    // Mostly members of the set, with an occasional outsider anywhere.
+    std::string randomField(tests::Random& random, const char* members)
+    {
+        std::size_t count = std::strlen(members);
+        std::string text(random.below(100), ' ');
+        for (char& c : text)
+            c = members[random.below(count)];
+        for (std::size_t n = random.below(3); n > 0 && !text.empty(); --n)
+            text[random.below(text.size())] = random.below(2) == 0 ? kEdges[random.below(sizeof kEdges)]
+                                                                   : kRecordBytes[random.below(sizeof kRecordBytes - 1)];
+        return text;
+    }
+
+    bool sameSplit(const RecordSplit& a, const RecordSplit& b)
+    {
+        if (a.length != b.length || a.barCount != b.barCount)
+            return false;
+        for (std::size_t i = 0; i < a.barCount; ++i)
+            if (a.bars[i] != b.bars[i])
+                return false;
+        return true;
+    }
+}
+
+TEST(field_scan_kernels_match_the_scalar_one)
+{
+    std::vector<FieldScanKernels> all = fieldScanKernels();
+    CHECK(!all.empty());
+    CHECK_EQ(std::string(all.front().name), std::string(fieldScanImplementation()));
+    CHECK_EQ(std::string(all.back().name), std::string("scalar"));
+
+    const FieldScanKernels& scalar = all.back();
+    tests::Random random(8);
+    std::vector<char> buffer;
+    for (const FieldScanKernels& k : all)
+    {
+        std::size_t mismatches = 0;
+        for (int i = 0; i < 200000; ++i)
+        {
+            std::string record = randomRecord(random);
+            std::string email  = randomField(random, "abcxyzABCXYZ0189.@");
+            std::string phone  = randomField(random, "0123456789+()-");
+
+            // Copied to a random offset so the kernels see every alignment.
+            std::size_t offset = random.below(32);
+            for (const std::string* text : { &record, &email, &phone })
+            {
+                buffer.assign(offset, 'x');
+                buffer.insert(buffer.end(), text->begin(), text->end());
+                const char* p = buffer.data() + offset;
+                std::size_t n = text->size();
+
+                bool same = text != &record || sameSplit(k.scanRecord(p, n), scalar.scanRecord(p, n));
+                same = same && k.isEmailCharset(p, n) == scalar.isEmailCharset(p, n);
+                same = same && k.isPhoneCharset(p, n) == scalar.isPhoneCharset(p, n);
+                if (!same && ++mismatches <= 5)
+                    tests::fail(__FILE__, __LINE__, std::string(k.name) + " differs on '" + *text + "'");
+            }
+        }
+        CHECK_EQ(mismatches, 0u);
+    }
+
+    // The entry points run the chosen implementation.
+    CHECK_EQ(scanRecord("a|b|c\nd|e").barCount, 2u);
+    CHECK(isEmailCharset("ivan.petrov@mail.ru"));
+    CHECK(!isEmailCharset("ivan petrov@mail.ru"));
+    CHECK(isPhoneCharset("+7(999)123-45-67"));
+    CHECK(!isPhoneCharset("+7 999 123 45 67"));
+}
@@ -0,0 +1,359 @@
+#include "fuzzy_index.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+    // Trigrams are padded with a byte no name contains, so word starts and ends count too.
+    const unsigned char kPad = 1;
+
+    char fold(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // Words of a name field or a query: runs between spaces and hyphens.
+    template <typename F>
+    void forEachWord(std::string_view text, F f)
+    {
+        std::size_t i = 0;
+        while (i < text.size())
+        {
+            while (i < text.size() && (text[i] == ' ' || text[i] == '-' || text[i] == '\t'))
+                ++i;
+
+            std::size_t begin = i;
+            while (i < text.size() && text[i] != ' ' && text[i] != '-' && text[i] != '\t')
+                ++i;
+
+            if (i > begin)
+                f(text.substr(begin, i - begin));
+        }
+    }
+
+    template <typename F>
+    void forEachNameWord(const Contact& c, F f)
+    {
+        forEachWord(c.getName(), f);
+        forEachWord(c.getSurname(), f);
+        forEachWord(c.getPatronymic(), f);
+    }
+
+    // Appends the trigrams of "<pad><pad>word<pad>": one per letter plus one.
+    void appendGrams(std::string_view word, std::vector<std::uint32_t>& out)
+    {
+        std::uint32_t window = (kPad << 8) | kPad;
+        for (char c : word)
+        {
+            window = ((window << 8) | static_cast<unsigned char>(fold(c))) & 0xFFFFFF;
+            out.push_back(window);
+        }
+        out.push_back(((window << 8) | kPad) & 0xFFFFFF);
+    }
+
+    void sortUnique(std::vector<std::uint32_t>& grams)
+    {
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    }
+
+    // Distinct case-folded words of the name fields.
+    std::vector<std::string> contactWords(const Contact& c)
+    {
+        std::vector<std::string> words;
+        forEachNameWord(c, [&](std::string_view word)
+        {
+            std::string folded(word);
+            for (char& ch : folded)
+                ch = fold(ch);
+            words.push_back(std::move(folded));
+        });
+
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        return words;
+    }
+
+    unsigned editBudget(std::size_t length)
+    {
+        return length <= 4 ? 1 : length <= 8 ? 2 : 3;
+    }
+
+    // Match masks of a pattern of at most 64 characters, built once and run
+    // against many texts.
+    class Pattern
+    {
+    public:
+        explicit Pattern(std::string_view text)
+            : length_(text.size())
+        {
+            std::fill(std::begin(peq_), std::end(peq_), 0);
+            for (std::size_t i = 0; i < text.size(); ++i)
+                peq_[static_cast<unsigned char>(fold(text[i]))] |= std::uint64_t(1) << i;
+        }
+
+        unsigned distance(std::string_view text) const
+        {
+            if (length_ == 0)
+                return static_cast<unsigned>(text.size());
+
+            // Hyyrö's formulation of Myers' algorithm: one column of the DP
+            // matrix per text character, held as vertical delta bit vectors.
+            std::uint64_t pv = ~std::uint64_t(0);
+            std::uint64_t mv = 0;
+            const std::uint64_t last = std::uint64_t(1) << (length_ - 1);
+            unsigned score = static_cast<unsigned>(length_);
+
+            for (char c : text)
+            {
+                std::uint64_t eq = peq_[static_cast<unsigned char>(fold(c))];
+                std::uint64_t xv = eq | mv;
+                std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+                std::uint64_t ph = mv | ~(xh | pv);
+                std::uint64_t mh = pv & xh;
+
+                if (ph & last)
+                    ++score;
+                else if (mh & last)
+                    --score;
+
+                ph = (ph << 1) | 1;
+                mh <<= 1;
+                pv = mh | ~(xv | ph);
+                mv = ph & xv;
+            }
+            return score;
+        }
+
+    private:
+        std::uint64_t peq_[256];
+        std::size_t   length_;
+    };
+
+    unsigned plainDistance(std::string_view a, std::string_view b)
+    {
+        std::vector<unsigned> row(b.size() + 1);
+        std::iota(row.begin(), row.end(), 0u);
+
+        for (std::size_t i = 1; i <= a.size(); ++i)
+        {
+            unsigned diagonal = row[0];
+            row[0] = static_cast<unsigned>(i);
+            for (std::size_t j = 1; j <= b.size(); ++j)
+            {
+                unsigned above = row[j];
+                unsigned cost  = fold(a[i - 1]) == fold(b[j - 1]) ? 0 : 1;
+                row[j] = std::min({ row[j] + 1, row[j - 1] + 1, diagonal + cost });
+                diagonal = above;
+            }
+        }
+        return row[b.size()];
+    }
+}
+
+void FuzzyIndex::clear()
+{
+    words_.clear();
+    wordIds_.clear();
+    grams_.clear();
+}
+
+void FuzzyIndex::insert(std::size_t handle, const Contact& contact)
+{
+    std::vector<Gram> grams;
+    for (std::string& text : contactWords(contact))
+    {
+        auto it = wordIds_.find(text);
+        if (it == wordIds_.end())
+        {
+            // Dictionary words stay once seen, so their trigrams are indexed only once.
+            std::uint32_t id = static_cast<std::uint32_t>(words_.size());
+
+            grams.clear();
+            appendGrams(text, grams);
+            sortUnique(grams);
+            for (Gram g : grams)
+                grams_[g].push_back(id);
+
+            it = wordIds_.emplace(text, id).first;
+            words_.push_back(Word{ std::move(text), {} });
+        }
+        words_[it->second].contacts.push_back(static_cast<std::uint32_t>(handle));
+    }
+}
+
+void FuzzyIndex::erase(std::size_t handle, const Contact& contact)
+{
+    for (const std::string& text : contactWords(contact))
+    {
+        auto it = wordIds_.find(text);
+        if (it == wordIds_.end())
+            continue;
+
+        // Lists are unordered, so the entry is swapped with the last one and dropped.
+        std::vector<std::uint32_t>& list = words_[it->second].contacts;
+        auto pos = std::find(list.begin(), list.end(), static_cast<std::uint32_t>(handle));
+        if (pos == list.end())
+            continue;
+
+        *pos = list.back();
+        list.pop_back();
+    }
+}
+
+void FuzzyIndex::matchWord(std::string_view word, unsigned budget,
+                           std::vector<std::pair<std::uint32_t, unsigned>>& out) const
+{
+    std::vector<Gram> grams;
+    appendGrams(word, grams);
+    sortUnique(grams);
+
+    // Each edit destroys at most three trigrams, so a word within budget k
+    // shares at least (trigrams of the query word - 3k) of them. Shorter query
+    // words cannot be filtered that way and are checked against every word.
+    std::vector<std::uint32_t> candidates;
+    if (grams.size() > 3 * budget)
+    {
+        std::size_t need = grams.size() - 3 * budget;
+        std::vector<std::uint16_t> hits(words_.size());
+
+        for (Gram g : grams)
+        {
+            auto it = grams_.find(g);
+            if (it == grams_.end())
+                continue;
+
+            for (std::uint32_t id : it->second)
+            {
+                if (++hits[id] == need)
+                    candidates.push_back(id);
+            }
+        }
+    }
+    else
+    {
+        candidates.resize(words_.size());
+        std::iota(candidates.begin(), candidates.end(), 0u);
+    }
+
+    Pattern pattern(word.substr(0, 64));
+    for (std::uint32_t id : candidates)
+    {
+        const Word& w = words_[id];
+        if (w.contacts.empty())
+            continue;
+
+        std::size_t diff = w.text.size() > word.size() ? w.text.size() - word.size() : word.size() - w.text.size();
+        if (diff > budget)
+            continue;
+
+        unsigned d = word.size() <= 64 ? pattern.distance(w.text) : plainDistance(word, w.text);
+        if (d <= budget)
+            out.emplace_back(id, d);
+    }
+}
+
+std::vector<FuzzyIndex::Match> FuzzyIndex::search(std::string_view query, std::size_t limit,
+                                                  const std::vector<Contact>& contacts) const
+{
+    struct QueryWord
+    {
+        std::string_view                                text;
+        unsigned                                        budget;
+        std::vector<std::pair<std::uint32_t, unsigned>> matches;
+        std::size_t                                     volume = 0;
+    };
+
+    std::vector<QueryWord> words;
+    forEachWord(query, [&](std::string_view w) { words.push_back(QueryWord{ w, editBudget(w.size()), {} }); });
+    if (words.empty() || limit == 0 || contacts.empty())
+        return {};
+
+    // Every query word must match some dictionary word; the one used by the
+    // fewest contacts picks the candidates.
+    std::size_t pivot = 0;
+    for (std::size_t i = 0; i < words.size(); ++i)
+    {
+        matchWord(words[i].text, words[i].budget, words[i].matches);
+        if (words[i].matches.empty())
+            return {};
+
+        for (const auto& m : words[i].matches)
+            words[i].volume += words_[m.first].contacts.size();
+        if (words[i].volume < words[pivot].volume)
+            pivot = i;
+    }
+
+    std::vector<std::pair<std::uint32_t, unsigned>>& pivotMatches = words[pivot].matches;
+    std::sort(pivotMatches.begin(), pivotMatches.end(),
+              [](const auto& a, const auto& b) { return a.second < b.second; });
+
+    // Closest dictionary words first, so the first sighting of a contact carries its best distance.
+    std::vector<Match> candidates;
+    std::vector<bool> seen(contacts.size());
+    for (const auto& m : pivotMatches)
+    {
+        for (std::uint32_t h : words_[m.first].contacts)
+        {
+            if (!seen[h])
+            {
+                seen[h] = true;
+                candidates.push_back(Match{ h, m.second });
+            }
+        }
+    }
+
+    std::vector<Pattern> patterns;
+    patterns.reserve(words.size());
+    for (const QueryWord& w : words)
+        patterns.emplace_back(w.text.substr(0, 64));
+
+    std::vector<Match> matches;
+    for (Match c : candidates)
+    {
+        bool ok = true;
+        for (std::size_t i = 0; i < words.size() && ok; ++i)
+        {
+            if (i == pivot)
+                continue;
+
+            unsigned best = words[i].budget + 1;
+            forEachNameWord(contacts[c.handle], [&](std::string_view name)
+            {
+                unsigned d = words[i].text.size() <= 64 ? patterns[i].distance(name)
+                                                        : plainDistance(words[i].text, name);
+                best = std::min(best, d);
+            });
+
+            ok          = best <= words[i].budget;
+            c.distance += best;
+        }
+
+        if (ok)
+            matches.push_back(c);
+    }
+
+    auto better = [](const Match& a, const Match& b)
+    {
+        return a.distance != b.distance ? a.distance < b.distance : a.handle < b.handle;
+    };
+
+    if (matches.size() > limit)
+    {
+        std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(limit), matches.end(), better);
+        matches.resize(limit);
+    }
+    else
+    {
+        std::sort(matches.begin(), matches.end(), better);
+    }
+    return matches;
+}
+
+unsigned FuzzyIndex::editDistance(std::string_view a, std::string_view b)
+{
+    if (a.size() > 64)
+        return plainDistance(a, b);
+    return Pattern(a).distance(b);
+}
@@ -0,0 +1,64 @@
+#ifndef FUZZY_INDEX_H
+#define FUZZY_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Contact_class.h"
+
+// Typo-tolerant search over name, surname and patronymic. The distinct words
+// of those fields form a case-folded dictionary; each dictionary word lists the
+// contacts using it, and a trigram index (padded at the word edges) maps to the
+// dictionary words containing each trigram. A query word is matched against the
+// dictionary, where only words sharing enough trigrams to be within its edit
+// budget are measured, so the work grows with the vocabulary rather than with
+// the number of contacts.
+//
+// Contacts are identified by their slot in the caller's list, as ContactStore
+// handles are; the index does not keep the contacts themselves.
+class FuzzyIndex
+{
+public:
+    struct Match
+    {
+        std::size_t handle;
+        unsigned    distance;
+    };
+
+    void clear();
+    void insert(std::size_t handle, const Contact& contact);
+    void erase (std::size_t handle, const Contact& contact);
+
+    // Up to limit contacts in which every query word is within its edit budget
+    // of some name word (1 edit up to 4 letters, 2 up to 8, 3 beyond), best
+    // first; distance is the sum over the query words.
+    std::vector<Match> search(std::string_view query, std::size_t limit,
+                              const std::vector<Contact>& contacts) const;
+
+    // Levenshtein distance, ASCII case-insensitive. Bit-parallel (Myers/Hyyrö)
+    // when a is at most 64 characters long.
+    static unsigned editDistance(std::string_view a, std::string_view b);
+
+private:
+    using Gram = std::uint32_t;
+
+    struct Word
+    {
+        std::string                text;
+        std::vector<std::uint32_t> contacts;
+    };
+
+    // Dictionary words within budget of word, with their distances.
+    void matchWord(std::string_view word, unsigned budget,
+                   std::vector<std::pair<std::uint32_t, unsigned>>& out) const;
+
+    std::vector<Word>                                    words_;
+    std::unordered_map<std::string, std::uint32_t>       wordIds_;
+    std::unordered_map<Gram, std::vector<std::uint32_t>> grams_;
+};
+
+#endif // FUZZY_INDEX_H
@@ -0,0 +1,203 @@
+#include "contact_store.h"
+#include "contact_tests.h"
+#include "fuzzy_index.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ContactStore::findSimilar() against a scan of every contact with a plain
+// Levenshtein table, as the store goes through adds, replaces and the
+// swap-with-last of remove().
+
+namespace
+{
+    const char* const kSyllables[] = { "an", "na", "iv", "ov", "pet", "ro", "ma", "ri", "ya", "el", "ko", "va" };
+
+    char fold(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    unsigned levenshtein(std::string_view a, std::string_view b)
+    {
+        std::vector<std::vector<unsigned>> d(a.size() + 1, std::vector<unsigned>(b.size() + 1));
+        for (std::size_t i = 0; i <= a.size(); ++i)
+            d[i][0] = static_cast<unsigned>(i);
+        for (std::size_t j = 0; j <= b.size(); ++j)
+            d[0][j] = static_cast<unsigned>(j);
+
+        for (std::size_t i = 1; i <= a.size(); ++i)
+        {
+            for (std::size_t j = 1; j <= b.size(); ++j)
+            {
+                unsigned cost = fold(a[i - 1]) == fold(b[j - 1]) ? 0 : 1;
+                d[i][j] = std::min({ d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + cost });
+            }
+        }
+        return d[a.size()][b.size()];
+    }
+
+    std::vector<std::string_view> words(std::string_view text)
+    {
+        std::vector<std::string_view> out;
+        std::size_t i = 0;
+        while (i < text.size())
+        {
+            std::size_t end = text.find_first_of(" -\t", i);
+            if (end == std::string_view::npos)
+                end = text.size();
+            if (end > i)
+                out.push_back(text.substr(i, end - i));
+            i = end + 1;
+        }
+        return out;
+    }
+
+    std::vector<FuzzyIndex::Match> bruteForce(const ContactStore& store, std::string_view query, std::size_t limit)
+    {
+        std::vector<std::string_view> queryWords = words(query);
+        std::vector<FuzzyIndex::Match> result;
+        if (queryWords.empty())
+            return result;
+
+        const std::vector<Contact>& contacts = store.contacts();
+        for (std::size_t h = 0; h < contacts.size(); ++h)
+        {
+            std::vector<std::string_view> names;
+            for (std::string_view field : { contacts[h].getName(), contacts[h].getSurname(), contacts[h].getPatronymic() })
+            {
+                std::vector<std::string_view> w = words(field);
+                names.insert(names.end(), w.begin(), w.end());
+            }
+
+            bool ok = true;
+            unsigned total = 0;
+            for (std::string_view q : queryWords)
+            {
+                unsigned budget = q.size() <= 4 ? 1 : q.size() <= 8 ? 2 : 3;
+                unsigned best = budget + 1;
+                for (std::string_view n : names)
+                    best = std::min(best, levenshtein(q, n));
+                ok = ok && best <= budget;
+                total += best;
+            }
+            if (ok)
+                result.push_back(FuzzyIndex::Match{ h, total });
+        }
+
+        std::sort(result.begin(), result.end(), [](const FuzzyIndex::Match& a, const FuzzyIndex::Match& b)
+        {
+            return a.distance != b.distance ? a.distance < b.distance : a.handle < b.handle;
+        });
+        if (result.size() > limit)
+            result.resize(limit);
+        return result;
+    }
+
+    std::string word(tests::Random& random)
+    {
+        std::string w;
+        for (std::size_t n = 2 + random.below(3); n > 0; --n)
+            w += kSyllables[random.below(std::size(kSyllables))];
+        w[0] = static_cast<char>(w[0] - 'a' + 'A');
+        return w;
+    }
+
+    // One to three edits, with the letters' case flipped at random.
+    std::string typo(std::string w, tests::Random& random)
+    {
+        for (std::size_t n = 1 + random.below(3); n > 0; --n)
+        {
+            std::size_t at = random.below(w.size());
+            char letter = static_cast<char>('a' + random.below(26));
+            switch (random.below(3))
+            {
+            case 0:  w[at] = letter;           break;
+            case 1:  w.insert(at, 1, letter);  break;
+            default: if (w.size() > 1) w.erase(at, 1);
+            }
+        }
+        for (char& c : w)
+        {
+            if (random.below(4) == 0)
+                c = (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : fold(c);
+        }
+        return w;
+    }
+
+    Contact make(tests::Random& random, int id)
+    {
+        std::string name = word(random);
+        if (random.below(5) == 0)
+            name += "-" + word(random);
+        std::string patronymic = random.below(3) == 0 ? std::string() : word(random);
+
+        Contact::PhoneList phones;
+        phones.add(Contact::PhoneType::Work, "8999" + std::to_string(1000000 + id));
+        return Contact(name, word(random), patronymic, "f" + std::to_string(id) + "@mail.ru", "Addr",
+                       Contact::Date{1, 1, 1990}, phones);
+    }
+
+    std::string query(const ContactStore& store, tests::Random& random)
+    {
+        const Contact& c = store.at(random.below(store.size()));
+        std::vector<std::string_view> names = words(c.getName());
+        names.push_back(c.getSurname());
+
+        std::string q;
+        for (std::size_t n = 1 + random.below(2); n > 0; --n)
+        {
+            std::string w(names[random.below(names.size())]);
+            q += (q.empty() ? "" : " ") + (random.below(3) == 0 ? w : typo(w, random));
+        }
+        return q;
+    }
+
+    void checkQueries(const ContactStore& store, tests::Random& random, const char* phase)
+    {
+        std::size_t mismatches = 0;
+        for (int i = 0; i < 300; ++i)
+        {
+            std::string q = query(store, random);
+            std::size_t limit = random.below(2) == 0 ? 10 : store.size();
+            std::vector<FuzzyIndex::Match> expected = bruteForce(store, q, limit);
+            std::vector<FuzzyIndex::Match> actual   = store.findSimilar(q, limit);
+
+            bool same = expected.size() == actual.size() &&
+                        std::equal(expected.begin(), expected.end(), actual.begin(),
+                                   [](const FuzzyIndex::Match& a, const FuzzyIndex::Match& b)
+                                   { return a.handle == b.handle && a.distance == b.distance; });
+            if (!same && ++mismatches <= 5)
+                tests::fail(__FILE__, __LINE__, std::string(phase) + ": '" + q + "' finds " +
+                            std::to_string(actual.size()) + " contacts, the scan " + std::to_string(expected.size()));
+        }
+        CHECK_EQ(mismatches, 0u);
+    }
+}
+
+TEST(fuzzy_search_matches_a_levenshtein_scan)
+{
+    tests::Random random(19);
+    ContactStore store;
+    int id = 0;
+    for (; id < 400; ++id)
+        CHECK(store.add(make(random, id)));
+    checkQueries(store, random, "after adds");
+
+    for (int i = 0; i < 150; ++i, ++id)
+        CHECK(store.replace(random.below(store.size()), make(random, id)));
+    checkQueries(store, random, "after replaces");
+
+    // Each remove() moves the last contact into the freed slot.
+    for (int i = 0; i < 150; ++i)
+        CHECK(store.remove(random.below(store.size())));
+    for (int i = 0; i < 50; ++i, ++id)
+        CHECK(store.add(make(random, id)));
+    checkQueries(store, random, "after removes");
+
+    CHECK(store.findSimilar("", 10).empty());
+    CHECK(store.findSimilar(" - ", 10).empty());
+    CHECK(store.findSimilar(store.at(0).getSurname(), 0).empty());
+}
@@ -0,0 +1,8 @@
+TEMPLATE = app
+TARGET = loadgen
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += \
+        contact_loadgen.cpp
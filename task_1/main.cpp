@@ -1,69 +1,95 @@
-#include <iostream>
-#include <string>
-
-#include "Contact_class.h"
-#include "contact_app.h"
-#include "contact_storage.h"
-
-#include <limits>
-#include <vector>
-
-int main()
-{
-    const std::string filename = "contacts.txt";
-    std::vector<Contact> contacts;
-
-    if (!loadContacts(filename, contacts))
-    {
-        std::cout << "Cannot load contacts file. Starting with empty list.\n";
-    }
-
-    while (true)
-        {
-            std::cout << "\n===== MENU =====\n"
-                        "1. Show contacts\n"
-                        "2. Add contact\n"
-                        "3. Delete contact\n"
-                        "4. Edit contact\n"
-                        "5. Search contact\n"
-                        "6. Exit\n"
-                        "Your choice: ";
-
-            int choice = {};
-            std::cin >> choice;
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //
-
-            if (choice < 1 || choice > 6)
-            {
-                std::cout<<"Your choiсe is wrong!";
-                continue;
-            }
-
-            switch (choice)
-            {
-            case 1:
-                showContacts(contacts);
-                break;
-            case 2:
-                addContact(contacts);
-                saveContacts(filename, contacts);
-                break;
-            case 3:
-                deleteContact(contacts);
-                saveContacts(filename, contacts);
-                break;
-            case 4:
-                editContact(contacts);
-                saveContacts(filename, contacts);
-                break;
-            case 5:
-                searchContact(contacts);
-                break;
-            case 6:
-                std::cout<<"Thanks for using our program! Bye!\n";
-                return 0;
-            }
-
-        }
-    return 0;
-}
+#include <iostream>
+#include <string>
+
+#include "Contact_class.h"
+#include "contact_app.h"
+#include "contact_batch.h"
+#include "contact_profile.h"
+#include "contact_store.h"
+
+#include <limits>
+#include <vector>
+
+namespace
+{
+    void saveChanges(ContactStore& store)
+    {
+        if (!store.commit())
+            std::cout << "Cannot save changes to the contacts file.\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+        return runBatch(argc, argv);
+
+    const std::string filename = "contacts.txt";
+    ContactStore store;
+
+    if (!store.open(filename))
+    {
+        // Edits made now could not be saved, so do not start at all.
+        std::cout << "Cannot load " << filename << ". Fix or move the file and start again.\n";
+        return 1;
+    }
+    if (store.rejected() != 0)
+    {
+        std::cout << store.rejected() << " records could not be loaded and were moved to "
+                  << store.rejectedName() << ".\n";
+    }
+
+    while (true)
+        {
+            std::cout << "\n===== MENU =====\n"
+                        "1. Show contacts\n"
+                        "2. Add contact\n"
+                        "3. Delete contact\n"
+                        "4. Edit contact\n"
+                        "5. Search contact\n"
+                        "6. Exit\n";
+            if (profilingEnabled())
+                std::cout << "7. Profile report\n";
+            std::cout << "Your choice: ";
+
+            int choice = {};
+            std::cin >> choice;
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); //
+
+            if (choice < 1 || choice > (profilingEnabled() ? 7 : 6))
+            {
+                std::cout<<"Your choiсe is wrong!";
+                continue;
+            }
+
+            switch (choice)
+            {
+            case 1:
+                browseContacts(store);
+                break;
+            case 2:
+                addContact(store);
+                saveChanges(store);
+                break;
+            case 3:
+                deleteContact(store);
+                saveChanges(store);
+                break;
+            case 4:
+                editContact(store);
+                saveChanges(store);
+                break;
+            case 5:
+                searchContact(store);
+                break;
+            case 6:
+                std::cout<<"Thanks for using our program! Bye!\n";
+                return 0;
+            case 7:
+                dumpProfile(std::cout);
+                break;
+            }
+
+        }
+    return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file mapped into memory. An empty file maps to an
+// empty view. When open() fails, missing() tells a file that does not exist
+// from one that exists but cannot be read, such as a directory or a file
+// without read permission.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    std::string_view view()    const noexcept { return {data_, size_}; }
+    std::size_t      size()    const noexcept { return size_; }
+    bool             missing() const noexcept { return missing_; }
+
+private:
+    const char* data_    = nullptr;
+    std::size_t size_    = 0;
+    bool        missing_ = false;
+#ifdef _WIN32
+    void*       file_    = nullptr;
+    void*       mapping_ = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,166 @@
+#include "Contact_class.h"
+#include "contact_storage.h"
+#include "contact_store.h"
+#include "contact_tests.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Counts every allocation the process makes. Moving a contact must not touch
+// the heap: only a PhoneList that spilled out of its inline slots owns memory,
+// so the move tests use contacts with five phones. Loading must put each text
+// field into the StringPool once, straight from the file bytes.
+
+namespace
+{
+    std::atomic<std::size_t> allocations{0};
+
+    template <typename F>
+    std::size_t allocationsOf(F f)
+    {
+        std::size_t before = allocations.load();
+        f();
+        return allocations.load() - before;
+    }
+
+    Contact::PhoneList fivePhones(int id)
+    {
+        Contact::PhoneList phones;
+        for (int i = 0; i < 5; ++i)
+            phones.add(Contact::PhoneType::Work, "8999" + std::to_string(1000000 + id * 10 + i));
+        return phones;
+    }
+
+    Contact make(int id)
+    {
+        std::string tag = std::to_string(id);
+        return Contact("Name" + tag, "Surname", "", "m" + tag + "@mail.ru", "Addr", Contact::Date{1, 1, 1990},
+                       fivePhones(id));
+    }
+
+    // count records of three phones; names, surnames and patronymics are all
+    // different with distinct, else the same in every record.
+    std::string records(int count, bool distinct)
+    {
+        std::string text;
+        for (int i = 0; i < count; ++i)
+        {
+            std::string id  = std::to_string(i);
+            std::string tag = distinct ? id : std::string();
+            text += "Lname" + tag + "|Lsurname" + tag + "|Lpatronymic" + tag + "|Street " + id +
+                    "|01.01.1990|load" + id + "@mail.ru|Work:89990000001,Home:89990000002,Service:89990000003\n";
+        }
+        return text;
+    }
+
+    // Stores in the same state index a contact with the same allocations.
+    void prime(ContactStore& store)
+    {
+        for (int i = 0; i < 10; ++i)
+            store.add(make(i));
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+
+void operator delete  (void* p) noexcept              { std::free(p); }
+void operator delete[](void* p) noexcept              { std::free(p); }
+void operator delete  (void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+TEST(moving_a_contact_does_not_allocate)
+{
+    Contact c = make(100);
+    CHECK_EQ(allocationsOf([&] { Contact copy(c); }), 1u);
+
+    Contact other = make(101);
+    CHECK_EQ(allocationsOf([&] {
+        Contact moved(std::move(c));
+        other = std::move(moved);
+        c = std::move(other);
+    }), 0u);
+
+    CHECK_EQ(c.getPhones().size(), 5u);
+    CHECK_EQ(std::string(c.getemail()), std::string("m100@mail.ru"));
+
+    Contact::PhoneList phones = fivePhones(102);
+    CHECK_EQ(allocationsOf([&] {
+        Contact::PhoneList moved(std::move(phones));
+        phones = std::move(moved);
+    }), 0u);
+    CHECK_EQ(phones.size(), 5u);
+}
+
+TEST(store_takes_moved_contacts_without_copying)
+{
+    ContactStore byCopy, byMove, byEmplace;
+    prime(byCopy);
+    prime(byMove);
+    prime(byEmplace);
+
+    Contact a = make(200), b = make(200), c = make(200);
+    std::size_t copied   = allocationsOf([&] { CHECK(byCopy.add(a)); });
+    std::size_t moved    = allocationsOf([&] { CHECK(byMove.add(std::move(b))); });
+    std::size_t emplaced = allocationsOf([&] { CHECK(byEmplace.emplace(std::move(c))); });
+
+    // A copy duplicates the phone buffer; the moves hand it over.
+    CHECK_EQ(copied - moved, 1u);
+    CHECK_EQ(emplaced, moved);
+
+    Contact x = make(201), y = make(201);
+    ContactStore::Handle hCopy = byCopy.findByEmail("m200@mail.ru");
+    ContactStore::Handle hMove = byMove.findByEmail("m200@mail.ru");
+    std::size_t replacedByCopy = allocationsOf([&] { CHECK(byCopy.replace(hCopy, x)); });
+    std::size_t replacedByMove = allocationsOf([&] { CHECK(byMove.replace(hMove, std::move(y))); });
+    CHECK_EQ(replacedByCopy - replacedByMove, 1u);
+}
+
+TEST(loading_pools_each_text_once)
+{
+    const int kRecords = 2000;
+    tests::TempDir dir("load_allocations");
+    std::string same = dir.file("same.txt"), distinct = dir.file("distinct.txt");
+    std::ofstream(same) << records(kRecords, false);
+    std::ofstream(distinct) << records(kRecords, true);
+
+    std::vector<Contact> contacts;
+    contacts.reserve(kRecords);
+    std::size_t sameCount     = allocationsOf([&] { CHECK(loadContacts(same, contacts)); });
+    contacts.clear();
+    std::size_t parallelCount = allocationsOf([&] { CHECK(loadContactsParallel(same, contacts, 1)); });
+    contacts.clear();
+    std::size_t distinctCount = allocationsOf([&] { CHECK(loadContacts(distinct, contacts)); });
+    CHECK_EQ(contacts.size(), static_cast<std::size_t>(kRecords));
+
+    // Repeated names cost nothing per record: e-mails and addresses are copied
+    // into shared 64 KiB blocks and the three phones fit the inline slots. What
+    // remains is fixed: a few blocks, plus the table entries of the first names.
+    CHECK(sameCount <= 16);
+    CHECK(parallelCount <= 16);
+
+    // A name seen for the first time adds its one entry to the intern table:
+    // three per record here, plus the same fixed part and the table's rehashes.
+    CHECK(distinctCount >= 3u * kRecords);
+    CHECK(distinctCount <= 3u * kRecords + 200);
+
+    // A single line is parsed into a one-element vector; that is its only allocation.
+    CHECK_EQ(allocationsOf([&] {
+        std::optional<Contact> c = parseContactLine("Lname|Lsurname|Lpatronymic|Street 1|01.01.1990|line@mail.ru|"
+                                                    "Work:89990000001");
+        CHECK(c.has_value());
+    }), 1u);
+}
@@ -0,0 +1,177 @@
+#include "phone_index.h"
+
+#include <algorithm>
+
+namespace
+{
+    const std::uint64_t kKeySpace = 10000000000ULL;   // ten digits
+
+    // Collects the digits of text, skipping separators. False on any other character.
+    bool collectDigits(std::string_view text, std::uint64_t& value, std::size_t& count, char& first)
+    {
+        value = 0;
+        count = 0;
+        first = 0;
+        for (char c : text)
+        {
+            if (c >= '0' && c <= '9')
+            {
+                if (count == 0)
+                    first = c;
+                if (++count > 11)
+                    return false;
+                value = value * 10 + static_cast<std::uint64_t>(c - '0');
+            }
+            else if (c != ' ' && c != '(' && c != ')' && c != '-')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string_view trimSpaces(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+            text.remove_suffix(1);
+        return text;
+    }
+}
+
+std::vector<std::uint64_t> PhoneIndex::keysOf(const Contact& contact)
+{
+    std::vector<std::uint64_t> keys;
+    for (const Contact::PackedPhone& p : contact.getPhones())
+        keys.push_back(p.digits());
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+bool PhoneIndex::key(std::string_view number, std::uint64_t& key)
+{
+    number = trimSpaces(number);
+
+    bool plus = !number.empty() && number.front() == '+';
+    if (plus)
+        number.remove_prefix(1);
+
+    std::uint64_t value;
+    std::size_t   count;
+    char          first;
+    if (!collectDigits(number, value, count, first))
+        return false;
+
+    if (count == 11 && (first == '7' || (first == '8' && !plus)))
+    {
+        key = value % kKeySpace;
+        return true;
+    }
+    if (count == 10 && !plus)
+    {
+        key = value;
+        return true;
+    }
+    return false;
+}
+
+bool PhoneIndex::prefixRange(std::string_view prefix, std::uint64_t& from, std::uint64_t& to)
+{
+    prefix = trimSpaces(prefix);
+
+    bool plus = !prefix.empty() && prefix.front() == '+';
+    if (plus)
+        prefix.remove_prefix(1);
+
+    // A number opening with its area code in parentheses has no trunk digit.
+    bool national = !plus && !prefix.empty() && prefix.front() == '(';
+
+    std::uint64_t value;
+    std::size_t   count;
+    char          first;
+    if (!collectDigits(prefix, value, count, first) || count == 0)
+        return false;
+
+    // "+7" and the trunk "8" come before the national digits, as in key().
+    if (plus && first != '7')
+        return false;
+    if (plus || (first == '8' && !national))
+    {
+        std::uint64_t lead = 1;
+        for (std::size_t i = 1; i < count; ++i)
+            lead *= 10;
+        value %= lead;
+        --count;
+    }
+    if (count == 0 || count > 10)
+        return false;
+
+    std::uint64_t scale = 1;
+    for (std::size_t i = count; i < 10; ++i)
+        scale *= 10;
+
+    from = value * scale;
+    to   = (value + 1) * scale;
+    return true;
+}
+
+void PhoneIndex::clear()
+{
+    exact_.clear();
+    ordered_.clear();
+}
+
+void PhoneIndex::insert(Handle handle, const Contact& contact)
+{
+    for (std::uint64_t k : keysOf(contact))
+    {
+        exact_.emplace(k, handle);
+        ordered_.emplace(k, handle);
+    }
+}
+
+void PhoneIndex::erase(Handle handle, const Contact& contact)
+{
+    for (std::uint64_t k : keysOf(contact))
+    {
+        auto range = exact_.equal_range(k);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == handle)
+            {
+                exact_.erase(it);
+                break;
+            }
+        }
+        ordered_.erase(std::make_pair(k, handle));
+    }
+}
+
+std::vector<PhoneIndex::Handle> PhoneIndex::find(std::uint64_t key) const
+{
+    std::vector<Handle> result;
+    auto range = exact_.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+        result.push_back(it->second);
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::size_t PhoneIndex::visitRange(std::uint64_t from, std::uint64_t to,
+                                   const std::function<bool(Handle)>& visit, std::size_t limit) const
+{
+    std::size_t count = 0;
+    for (auto it = ordered_.lower_bound(std::make_pair(from, Handle(0)));
+         count < limit && it != ordered_.end() && it->first < to;
+         ++it)
+    {
+        ++count;
+        if (!visit(it->second))
+            break;
+    }
+    return count;
+}
@@ -0,0 +1,56 @@
+#ifndef PHONE_INDEX_H
+#define PHONE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Contact_class.h"
+
+// Reverse lookup from phone numbers to contacts. Every number is keyed by its
+// ten national digits, PackedPhone::digits(), so "+7(999)123-45-67" and
+// "89991234567" are the same key. A hash map answers exact lookups; an ordered
+// set of (key, handle) answers prefix lookups such as an area code as one range.
+//
+// Contacts are identified by their slot in the caller's list, as ContactStore
+// handles are.
+class PhoneIndex
+{
+public:
+    using Handle = std::size_t;
+
+    // Key of a number written in any accepted layout, or loosely as "+7" / "8"
+    // and ten digits, or just the ten digits; spaces, parentheses and dashes
+    // are ignored. False if it is not a complete number.
+    static bool key(std::string_view number, std::uint64_t& key);
+
+    // Key range [from, to) of all numbers starting with prefix: national
+    // digits, area code first ("999", "(999)12"), optionally after "+7" or
+    // the trunk "8" ("8999", "+7 999"). A leading 8 is the trunk unless it
+    // opens a parenthesized area code, so 8xx is written "8812", "+7812" or "(812)".
+    static bool prefixRange(std::string_view prefix, std::uint64_t& from, std::uint64_t& to);
+
+    // Distinct keys of a contact's numbers, so a number listed twice counts once.
+    static std::vector<std::uint64_t> keysOf(const Contact& contact);
+
+    void clear();
+    void insert(Handle handle, const Contact& contact);
+    void erase (Handle handle, const Contact& contact);
+
+    std::vector<Handle> find(std::uint64_t key) const;
+
+    // Visits handles with keys in [from, to) in key order, at most limit of
+    // them; returning false stops the walk. Returns how many were visited.
+    std::size_t visitRange(std::uint64_t from, std::uint64_t to,
+                           const std::function<bool(Handle)>& visit, std::size_t limit) const;
+
+private:
+    std::unordered_multimap<std::uint64_t, Handle> exact_;
+    std::set<std::pair<std::uint64_t, Handle>>     ordered_;
+};
+
+#endif // PHONE_INDEX_H
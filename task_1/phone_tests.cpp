@@ -0,0 +1,133 @@
+#include "contact_store.h"
+#include "contact_tests.h"
+#include "phone_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Phone keys in the notations PhoneIndex::key() accepts, and prefix lookups
+// through ContactStore against a scan of every stored number.
+
+namespace
+{
+    std::uint64_t keyOf(const std::string& number)
+    {
+        std::uint64_t key = 0;
+        CHECK(PhoneIndex::key(number, key));
+        return key;
+    }
+
+    Contact make(int id, const std::vector<std::string>& numbers)
+    {
+        Contact::PhoneList phones;
+        for (const std::string& n : numbers)
+            CHECK(phones.add(Contact::PhoneType::Home, n));
+        return Contact("Name", "Surname", "", "p" + std::to_string(id) + "@mail.ru", "Addr", Contact::Date{1, 1, 1990},
+                       phones);
+    }
+
+    std::vector<ContactStore::Handle> byPrefix(const ContactStore& store, const std::string& prefix)
+    {
+        std::vector<ContactStore::Handle> result;
+        CHECK(store.visitByPhonePrefix(prefix, [&](ContactStore::Handle h, const Contact&)
+        {
+            result.push_back(h);
+            return true;
+        }));
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Handles of contacts with a number whose national digits start with digits.
+    std::vector<ContactStore::Handle> scan(const ContactStore& store, const std::string& digits)
+    {
+        std::vector<ContactStore::Handle> result;
+        for (ContactStore::Handle h = 0; h < store.size(); ++h)
+        {
+            for (const Contact::PackedPhone& p : store.at(h).getPhones())
+            {
+                std::string national = std::to_string(p.digits());
+                national.insert(0, 10 - national.size(), '0');
+                if (national.compare(0, digits.size(), digits) == 0)
+                {
+                    result.push_back(h);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+}
+
+TEST(phone_keys_ignore_the_notation)
+{
+    const std::uint64_t expected = 9991234567ULL;
+    for (const char* number : { "89991234567", "+79991234567", "79991234567", "9991234567", "+7(999)123-45-67",
+                                "8 (999) 123 45 67", "8-999-123-45-67", "  +7 999 1234567\t", "(999)1234567" })
+        CHECK_EQ(keyOf(number), expected);
+
+    std::uint64_t key;
+    for (const char* number : { "", "+", "899912345", "899912345678", "+89991234567", "+9991234567",
+                                "69991234567", "8999123456x", "8.999.123.45.67", "+7+9991234567" })
+        CHECK(!PhoneIndex::key(number, key));
+}
+
+TEST(phone_prefixes_strip_the_country_code_and_trunk)
+{
+    std::uint64_t from = 0, to = 0;
+    for (const char* prefix : { "999", "8999", "+7999", "+7 (999)", "8(999)", " 8 999 " })
+    {
+        CHECK(PhoneIndex::prefixRange(prefix, from, to));
+        CHECK_EQ(from, 9990000000ULL);
+        CHECK_EQ(to, 9990000000ULL + 10000000ULL);
+    }
+
+    for (const char* prefix : { "8812", "+7812", "(812)", "8 (812)" })
+    {
+        CHECK(PhoneIndex::prefixRange(prefix, from, to));
+        CHECK_EQ(from, 8120000000ULL);
+    }
+    CHECK(PhoneIndex::prefixRange("89991234567", from, to));
+    CHECK_EQ(from, 9991234567ULL);
+    CHECK_EQ(to, 9991234568ULL);
+
+    for (const char* prefix : { "", "8", "+7", "+", "+8999", "999123456789", "89991234567 8", "99x" })
+        CHECK(!PhoneIndex::prefixRange(prefix, from, to));
+}
+
+TEST(phone_prefix_lookups_match_a_scan)
+{
+    ContactStore store;
+    CHECK(store.add(make(0, { "89991234567", "+7(812)555-00-11" })));
+    CHECK(store.add(make(1, { "8(999)765-43-21" })));
+    CHECK(store.add(make(2, { "+74951112233", "89161234567" })));
+    CHECK(store.add(make(3, { "88121234567" })));
+    CHECK(store.add(make(4, { "+79990000000" })));
+
+    const std::pair<const char*, const char*> prefixes[] = {
+        { "999", "999" },       { "8999", "999" },      { "+7999", "999" },     { "+7 (999) 12", "99912" },
+        { "8812", "812" },      { "+7812", "812" },     { "(812)555", "812555" }, { "89", "9" },
+        { "8(812)", "812" },
+        { "+74", "4" },         { "495", "495" },       { "89991234567", "9991234567" }, { "7", "7" },
+    };
+    for (const auto& p : prefixes)
+    {
+        std::vector<ContactStore::Handle> expected = scan(store, p.second);
+        if (byPrefix(store, p.first) != expected)
+            tests::fail(__FILE__, __LINE__, std::string("prefix '") + p.first + "' disagrees with the scan");
+    }
+    CHECK_EQ(byPrefix(store, "8999").size(), 3u);
+    CHECK_EQ(byPrefix(store, "+7812").size(), 2u);
+
+    // After a remove the last contact takes the freed slot, and its numbers move with it.
+    CHECK(store.remove(0));
+    CHECK(byPrefix(store, "8999") == scan(store, "999"));
+    CHECK(byPrefix(store, "8812") == scan(store, "812"));
+    CHECK(store.findByPhone("+7 999 000 00 00") == std::vector<ContactStore::Handle>{ 0 });
+
+    int visited = 0;
+    CHECK(!store.visitByPhonePrefix("8x", [&](ContactStore::Handle, const Contact&) { ++visited; return true; }));
+    CHECK_EQ(visited, 0);
+}
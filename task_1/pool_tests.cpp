@@ -0,0 +1,41 @@
+#include "contact_tests.h"
+#include "string_pool.h"
+
+#include <string>
+#include <vector>
+
+TEST(interned_text_is_shared_while_alive)
+{
+    PooledString a("Pool-Ivan");
+    PooledString b("Pool-Ivan");
+    CHECK(a.view().data() == b.view().data());
+
+    PooledString copy = a;
+    a = PooledString();
+    b = PooledString();
+    CHECK_EQ(std::string(copy.view()), std::string("Pool-Ivan"));
+    CHECK(a.empty());
+}
+
+TEST(pool_frees_blocks_of_dropped_strings)
+{
+    // Only the blocks the shards are still filling may stay behind, with the
+    // interned strings in them.
+    const std::size_t slack = 2 * 16 * (64 * 1024 + 64);
+    std::size_t before = StringPool::bytesReserved();
+
+    for (int round = 0; round < 3; ++round)
+    {
+        std::vector<PooledString> strings;
+        for (int i = 0; i < 200000; ++i)
+        {
+            std::string text = "pool-" + std::to_string(round) + "-" + std::to_string(i);
+            strings.emplace_back(text);
+            strings.emplace_back(text + "@mail.ru", PooledString::Stored);
+        }
+        CHECK(StringPool::bytesReserved() > before + slack);
+    }
+
+    CHECK(StringPool::bytesReserved() <= before + slack);
+    CHECK(StringPool::internedCount() < 100000);
+}
@@ -1,15 +1,46 @@
-TEMPLATE = app
-CONFIG += console c++17
-CONFIG -= app_bundle
-CONFIG -= qt
-
-SOURCES += \
-        Contact_class.cpp \
-        contact_app.cpp \
-        contact_storage.cpp \
-        main.cpp
-
-HEADERS += \
-    Contact_class.h \
-    contact_app.h \
-    contact_storage.h
+TEMPLATE = app
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# qmake CONFIG+=contacts_profile builds in the instrumentation of contact_profile.h.
+contacts_profile: DEFINES += CONTACTS_PROFILE
+
+SOURCES += \
+        Contact_class.cpp \
+        contact_app.cpp \
+        contact_batch.cpp \
+        contact_codec.cpp \
+        contact_profile.cpp \
+        contact_server.cpp \
+        contact_shared_store.cpp \
+        contact_snapshot.cpp \
+        contact_storage.cpp \
+        contact_store.cpp \
+        contact_table.cpp \
+        contact_writer.cpp \
+        field_scan.cpp \
+        fuzzy_index.cpp \
+        main.cpp \
+        mapped_file.cpp \
+        phone_index.cpp \
+        string_pool.cpp
+
+HEADERS += \
+    Contact_class.h \
+    contact_app.h \
+    contact_batch.h \
+    contact_codec.h \
+    contact_profile.h \
+    contact_server.h \
+    contact_shared_store.h \
+    contact_snapshot.h \
+    contact_storage.h \
+    contact_store.h \
+    contact_table.h \
+    contact_writer.h \
+    field_scan.h \
+    fuzzy_index.h \
+    mapped_file.h \
+    phone_index.h \
+    string_pool.h
@@ -0,0 +1,147 @@
+#include "contact_shared_store.h"
+#include "contact_tests.h"
+#include "phone_index.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Readers check every version they see while writers add, replace and remove
+// contacts: each version must be consistent with its own indexes and must not
+// change while a reader holds it.
+
+namespace
+{
+    const int kStable   = 500;   // never removed, only replaced
+    const int kWriters  = 3;
+    const int kReaders  = 4;
+    const int kRounds   = 300;
+    const int kPerRound = 20;
+
+    std::string number(int id)
+    {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "8999%07d", id);
+        return buf;
+    }
+
+    // The name, the address and the phone all carry the same id and version,
+    // so a contact put together from two writes is easy to spot.
+    Contact make(const std::string& email, int id, int version)
+    {
+        std::string tag = std::to_string(id) + "v" + std::to_string(version);
+        Contact::PhoneList phones;
+        phones.add(Contact::PhoneType::Work, number(id));
+        return Contact("N" + tag, "S", "", email, "Addr " + tag, Contact::Date{1, 1, 1990}, std::move(phones));
+    }
+
+    std::string stableEmail(int i)         { return "s" + std::to_string(i) + "@mail.ru"; }
+    std::string writerEmail(int w, int i)  { return "w" + std::to_string(w) + "-" + std::to_string(i) + "@mail.ru"; }
+
+    // Returns the number of problems found in v.
+    std::size_t check(const SharedContactStore::View& v)
+    {
+        std::size_t problems = 0;
+
+        std::size_t visited = v.visit([&](SharedContactStore::Handle h, const Contact& c)
+        {
+            std::string_view name = c.getName();
+            std::string_view address = c.getAddress();
+            if (name.substr(1) != address.substr(5))
+                ++problems;
+            if (v.findByEmail(c.getemail()) != h)
+                ++problems;
+
+            std::uint64_t key = 0;
+            if (!PhoneIndex::key(c.getPhones()[0].number(), key) || v.findByPhone(key) != h)
+                ++problems;
+            return true;
+        });
+        if (visited != v.size())
+            ++problems;
+
+        for (int i = 0; i < kStable; ++i)
+        {
+            if (v.findByEmail(stableEmail(i)) == SharedContactStore::npos)
+                ++problems;
+        }
+        return problems;
+    }
+
+    // What a reader remembers of a version, to compare after writers moved on.
+    std::vector<std::string> fingerprint(const SharedContactStore::View& v)
+    {
+        std::vector<std::string> out;
+        v.visit([&](SharedContactStore::Handle, const Contact& c)
+        {
+            out.push_back(std::string(c.getemail()) + '|' + std::string(c.getAddress()));
+            return true;
+        });
+        return out;
+    }
+}
+
+TEST(shared_store_readers_see_consistent_versions)
+{
+    std::vector<Contact> initial;
+    for (int i = 0; i < kStable; ++i)
+        initial.push_back(make(stableEmail(i), i, 0));
+    SharedContactStore store(initial);
+
+    std::atomic<int>         writersLeft{kWriters};
+    std::atomic<std::size_t> problems{0};
+    std::atomic<std::size_t> failedWrites{0};
+    std::atomic<std::size_t> versionsChecked{0};
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < kWriters; ++w)
+    {
+        threads.emplace_back([&, w]
+        {
+            int base = 100000 * (w + 1);
+            for (int round = 0; round < kRounds; ++round)
+            {
+                for (int i = 0; i < kPerRound; ++i)
+                    failedWrites += !store.add(make(writerEmail(w, i), base + i, round));
+                for (int i = 0; i < kPerRound; i += 2)
+                    failedWrites += !store.replace(writerEmail(w, i), make(writerEmail(w, i), base + i, round + 1));
+
+                int s = (round * kWriters + w) % kStable;
+                failedWrites += !store.replace(stableEmail(s), make(stableEmail(s), s, round + 1));
+
+                for (int i = 0; i < kPerRound; ++i)
+                    failedWrites += !store.remove(writerEmail(w, i));
+            }
+            --writersLeft;
+        });
+    }
+
+    for (int r = 0; r < kReaders; ++r)
+    {
+        threads.emplace_back([&]
+        {
+            while (writersLeft > 0)
+            {
+                std::shared_ptr<const SharedContactStore::View> v = store.view();
+                std::vector<std::string> before = fingerprint(*v);
+                problems += check(*v);
+                if (fingerprint(*v) != before)
+                    ++problems;
+                ++versionsChecked;
+            }
+        });
+    }
+
+    for (std::thread& t : threads)
+        t.join();
+
+    CHECK_EQ(problems.load(), 0u);
+    CHECK_EQ(failedWrites.load(), 0u);
+    CHECK(versionsChecked.load() > 0);
+
+    std::shared_ptr<const SharedContactStore::View> last = store.view();
+    CHECK_EQ(last->size(), static_cast<std::size_t>(kStable));
+    CHECK_EQ(check(*last), 0u);
+}
@@ -0,0 +1,134 @@
+#include "contact_storage.h"
+#include "contact_store.h"
+#include "contact_tests.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+
+// ContactStore::open() against files that are missing, unreadable or not files
+// at all. A store that failed to open must leave every file as it found it.
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    const char* const kRecord = "Ivan|Petrov|Ivanovich|Moscow|01.01.1990|ivan@mail.ru|Work:89991234567";
+
+    void write(const std::string& path, const std::string& text)
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << text;
+    }
+
+    std::string read(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    // Takes every permission away; false if the file can still be read (as root).
+    bool makeUnreadable(const std::string& path)
+    {
+        fs::permissions(path, fs::perms::none);
+        return !std::ifstream(path).is_open();
+    }
+
+    // After a failed open() no file is bound, so edits reach no journal.
+    void checkNothingBound(ContactStore& store, const std::string& contacts)
+    {
+        std::optional<Contact> c = parseContactLine("Anna|Sidorova||Kazan|02.02.1992|anna@mail.ru|Home:89997654321");
+        CHECK(c.has_value());
+        if (c)
+            store.add(std::move(*c));
+        store.commit();
+        CHECK(!fs::exists(contacts + ".journal"));
+    }
+}
+
+TEST(open_loads_a_missing_file_as_empty)
+{
+    tests::TempDir dir("missing");
+    std::string contacts = dir.file("contacts.txt");
+
+    ContactStore store;
+    CHECK(store.open(contacts));
+    CHECK(store.empty());
+
+    std::optional<Contact> c = parseContactLine(kRecord);
+    CHECK(c.has_value() && store.add(std::move(*c)));
+    CHECK(store.commit());
+    CHECK(fs::exists(contacts + ".journal"));
+}
+
+TEST(open_refuses_a_contacts_file_it_cannot_read)
+{
+    tests::TempDir dir("unreadable_file");
+    std::string contacts = dir.file("contacts.txt");
+
+    // A directory in place of the file fails even for root.
+    fs::create_directory(contacts);
+    ContactStore store;
+    CHECK(!store.open(contacts));
+    checkNothingBound(store, contacts);
+    CHECK(fs::is_directory(contacts));
+
+    fs::remove(contacts);
+    write(contacts, std::string(kRecord) + '\n');
+    if (makeUnreadable(contacts))
+    {
+        ContactStore other;
+        CHECK(!other.open(contacts));
+        checkNothingBound(other, contacts);
+        fs::permissions(contacts, fs::perms::owner_read | fs::perms::owner_write);
+        CHECK_EQ(read(contacts), std::string(kRecord) + '\n');
+    }
+}
+
+TEST(open_refuses_a_journal_it_cannot_read)
+{
+    tests::TempDir dir("unreadable_journal");
+    std::string contacts = dir.file("contacts.txt");
+    write(contacts, std::string(kRecord) + '\n');
+
+    fs::create_directory(contacts + ".journal");
+    ContactStore store;
+    CHECK(!store.open(contacts));
+    CHECK(fs::is_directory(contacts + ".journal"));
+    CHECK_EQ(read(contacts), std::string(kRecord) + '\n');
+
+    fs::remove(contacts + ".journal");
+    write(contacts + ".journal", "D|ivan@mail.ru\n");
+    if (makeUnreadable(contacts + ".journal"))
+    {
+        ContactStore other;
+        CHECK(!other.open(contacts));
+        CHECK_EQ(read(contacts), std::string(kRecord) + '\n');
+    }
+
+    // Once readable, the journal is replayed as usual.
+    fs::permissions(contacts + ".journal", fs::perms::owner_read | fs::perms::owner_write);
+    ContactStore replayed;
+    CHECK(replayed.open(contacts));
+    CHECK(replayed.empty());
+}
+
+TEST(remove_moves_the_last_contact_into_the_freed_slot)
+{
+    ContactStore store;
+    for (const char* name : { "Anna", "Boris", "Clara", "Denis" })
+    {
+        std::optional<Contact> c = parseContactLine(std::string(name) + "|Petrov||Moscow|01.01.1990|" + name +
+                                                    "@mail.ru|Work:89991234567");
+        CHECK(c.has_value() && store.add(std::move(*c)));
+    }
+
+    CHECK(store.remove(store.findByEmail("Boris@mail.ru")));
+    CHECK_EQ(store.size(), 3u);
+    CHECK_EQ(std::string(store.at(0).getName()), std::string("Anna"));
+    CHECK_EQ(std::string(store.at(1).getName()), std::string("Denis"));
+    CHECK_EQ(std::string(store.at(2).getName()), std::string("Clara"));
+    CHECK_EQ(store.findByEmail("Denis@mail.ru"), ContactStore::Handle(1));
+}
@@ -0,0 +1,230 @@
+#include "string_pool.h"
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <unordered_map>
+
+// Header of an arena block; the bytes follow it. An interned block keeps each
+// string behind its u32 length, so a dying block can find its table entries.
+struct StringPool::Block
+{
+    std::atomic<std::uint32_t> refs{1};
+    std::uint32_t              shard    = 0;
+    bool                       interned = false;
+    std::size_t                capacity = 0;
+    std::size_t                used     = 0;
+
+    char* bytes() noexcept { return reinterpret_cast<char*>(this + 1); }
+};
+
+namespace
+{
+    using Block = StringPool::Block;
+
+    const std::size_t kBlockSize  = 64 * 1024;
+    const std::size_t kShardCount = 16;
+
+    std::atomic<std::size_t> reservedBytes{0};
+
+    Block* newBlock(std::size_t capacity, bool interned, std::uint32_t shard)
+    {
+        Block* b = new (::operator new(sizeof(Block) + capacity)) Block;
+        b->shard    = shard;
+        b->interned = interned;
+        b->capacity = capacity;
+        reservedBytes.fetch_add(sizeof(Block) + capacity, std::memory_order_relaxed);
+        return b;
+    }
+
+    void freeBlock(Block* b)
+    {
+        reservedBytes.fetch_sub(sizeof(Block) + b->capacity, std::memory_order_relaxed);
+        b->~Block();
+        ::operator delete(b);
+    }
+
+    // A reference to a block whose count already reached zero must not be taken:
+    // that block is on its way out.
+    bool tryRetain(Block* b)
+    {
+        std::uint32_t refs = b->refs.load(std::memory_order_relaxed);
+        while (refs != 0)
+        {
+            if (b->refs.compare_exchange_weak(refs, refs + 1, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    // One lock, two current blocks and one lookup table per shard, so loader
+    // threads interning different strings rarely wait for each other. The shard
+    // holds a reference to each current block until it is full.
+    struct Shard
+    {
+        std::mutex                                   mutex;
+        Block*                                       internBlock = nullptr;
+        Block*                                       storeBlock  = nullptr;
+        std::unordered_map<std::string_view, Block*> interned;
+
+        // Copies text into a block and gives the caller a reference to it. A
+        // block the shard stops filling is handed back in retired, to be
+        // released once the lock is dropped.
+        std::string_view copy(std::string_view text, bool intern, std::uint32_t index, Block*& owner, Block*& retired)
+        {
+            std::size_t need = text.size() + (intern ? sizeof(std::uint32_t) : 0);
+
+            // Large strings get a block of their own and leave the current one alone.
+            Block* b;
+            if (need > kBlockSize / 4)
+            {
+                b = newBlock(need, intern, index);
+            }
+            else
+            {
+                Block*& current = intern ? internBlock : storeBlock;
+                if (!current || current->capacity - current->used < need)
+                {
+                    retired = current;
+                    current = newBlock(kBlockSize, intern, index);
+                }
+                b = current;
+                b->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            char* dst = b->bytes() + b->used;
+            if (intern)
+            {
+                std::uint32_t size = static_cast<std::uint32_t>(text.size());
+                std::memcpy(dst, &size, sizeof(size));
+                dst += sizeof(size);
+            }
+            std::memcpy(dst, text.data(), text.size());
+            b->used += need;
+
+            owner = b;
+            return {dst, text.size()};
+        }
+
+        // Drops the table entries still pointing into b, which is about to be freed.
+        void forget(Block* b)
+        {
+            std::size_t pos = 0;
+            while (pos < b->used)
+            {
+                std::uint32_t size;
+                std::memcpy(&size, b->bytes() + pos, sizeof(size));
+                std::string_view text(b->bytes() + pos + sizeof(size), size);
+
+                auto it = interned.find(text);
+                if (it != interned.end() && it->second == b)
+                    interned.erase(it);
+                pos += sizeof(size) + size;
+            }
+        }
+    };
+
+    // Never destroyed, so strings released during static destruction still find their shard.
+    Shard& shardAt(std::size_t i)
+    {
+        static Shard* shards = new Shard[kShardCount];
+        return shards[i % kShardCount];
+    }
+}
+
+std::string_view StringPool::intern(std::string_view text, Block*& block)
+{
+    block = nullptr;
+    if (text.empty())
+        return {};
+
+    std::uint32_t index = static_cast<std::uint32_t>(std::hash<std::string_view>()(text) % kShardCount);
+    Shard& shard = shardAt(index);
+
+    Block* retired = nullptr;
+    std::string_view pooled;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.interned.find(text);
+        if (it != shard.interned.end())
+        {
+            if (tryRetain(it->second))
+            {
+                block = it->second;
+                return it->first;
+            }
+            // The old copy dies with its block; this one replaces it in the table.
+            shard.interned.erase(it);
+        }
+
+        pooled = shard.copy(text, true, index, block, retired);
+        shard.interned.emplace(pooled, block);
+    }
+
+    if (retired)
+        release(retired);
+    return pooled;
+}
+
+std::string_view StringPool::store(std::string_view text, Block*& block)
+{
+    block = nullptr;
+    if (text.empty())
+        return {};
+
+    // Plain copies need no lookup, so any shard will do: each thread keeps to its own.
+    std::uint32_t index = static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) % kShardCount);
+    Shard& shard = shardAt(index);
+
+    Block* retired = nullptr;
+    std::string_view pooled;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        pooled = shard.copy(text, false, index, block, retired);
+    }
+
+    if (retired)
+        release(retired);
+    return pooled;
+}
+
+void StringPool::retain(Block* block) noexcept
+{
+    block->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StringPool::release(Block* block) noexcept
+{
+    if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+
+    // Nobody can take a new reference now (see tryRetain), but intern() may
+    // still find the block through the table until its entries are gone.
+    if (block->interned)
+    {
+        Shard& shard = shardAt(block->shard);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.forget(block);
+    }
+    freeBlock(block);
+}
+
+std::size_t StringPool::bytesReserved()
+{
+    return reservedBytes.load(std::memory_order_relaxed);
+}
+
+std::size_t StringPool::internedCount()
+{
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < kShardCount; ++i)
+    {
+        Shard& shard = shardAt(i);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.interned.size();
+    }
+    return total;
+}
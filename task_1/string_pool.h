@@ -0,0 +1,89 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+// Storage for the text fields of contacts. Bytes live in 64 KiB arena blocks
+// shared by many strings. Every PooledString holds a reference to its block,
+// and a block is freed with the last one, so memory comes back a block at a
+// time as contacts go and nothing is freed string by string. Equal interned
+// texts share one copy for as long as any of them is alive.
+// Safe to use from several threads.
+class StringPool
+{
+public:
+    struct Block;
+
+    // Returns the pooled copy of text; equal texts share one copy. The caller
+    // owns one reference to block (null for an empty text).
+    static std::string_view intern(std::string_view text, Block*& block);
+
+    // Copies text into the arena without looking for an equal one. For values
+    // that rarely repeat, such as e-mails and addresses.
+    static std::string_view store(std::string_view text, Block*& block);
+
+    static void retain (Block* block) noexcept;
+    static void release(Block* block) noexcept;
+
+    static std::size_t bytesReserved();
+    static std::size_t internedCount();
+};
+
+// A pointer into the pool that keeps its block alive. Copies share the bytes.
+class PooledString
+{
+public:
+    enum Mode {Interned, Stored};
+
+    PooledString() = default;
+    explicit PooledString(std::string_view text, Mode mode = Interned)
+    {
+        std::string_view pooled = mode == Interned ? StringPool::intern(text, block_) : StringPool::store(text, block_);
+        data_ = pooled.data();
+        size_ = static_cast<std::uint32_t>(pooled.size());
+    }
+
+    PooledString(const PooledString& other) noexcept
+        : data_(other.data_), size_(other.size_), block_(other.block_)
+    {
+        if (block_)
+            StringPool::retain(block_);
+    }
+
+    PooledString(PooledString&& other) noexcept
+        : data_(other.data_), size_(other.size_), block_(other.block_)
+    {
+        other.data_  = "";
+        other.size_  = 0;
+        other.block_ = nullptr;
+    }
+
+    PooledString& operator=(PooledString other) noexcept
+    {
+        std::swap(data_,  other.data_);
+        std::swap(size_,  other.size_);
+        std::swap(block_, other.block_);
+        return *this;
+    }
+
+    ~PooledString()
+    {
+        if (block_)
+            StringPool::release(block_);
+    }
+
+    std::string_view view()  const noexcept { return {data_, size_}; }
+    bool             empty() const noexcept { return size_ == 0; }
+
+    operator std::string_view() const noexcept { return view(); }
+
+private:
+    const char*        data_  = "";
+    std::uint32_t      size_  = 0;
+    StringPool::Block* block_ = nullptr;
+};
+
+#endif // STRING_POOL_H
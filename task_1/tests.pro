@@ -0,0 +1,52 @@
+TEMPLATE = app
+TARGET = contact_tests
+CONFIG += console c++17 thread
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Run ./contact_tests [name...]; it exits non-zero if a check fails.
+# contact_profile.cpp stays out: move_tests.cpp counts allocations with its own operator new.
+
+SOURCES += \
+        Contact_class.cpp \
+        batch_tests.cpp \
+        codec_tests.cpp \
+        contact_batch.cpp \
+        contact_codec.cpp \
+        contact_server.cpp \
+        contact_shared_store.cpp \
+        contact_snapshot.cpp \
+        contact_storage.cpp \
+        contact_store.cpp \
+        contact_tests.cpp \
+        contact_writer.cpp \
+        field_scan.cpp \
+        field_scan_tests.cpp \
+        fuzzy_index.cpp \
+        fuzzy_tests.cpp \
+        mapped_file.cpp \
+        move_tests.cpp \
+        phone_index.cpp \
+        phone_tests.cpp \
+        pool_tests.cpp \
+        shared_store_tests.cpp \
+        store_tests.cpp \
+        string_pool.cpp \
+        validator_tests.cpp
+
+HEADERS += \
+    Contact_class.h \
+    contact_batch.h \
+    contact_codec.h \
+    contact_server.h \
+    contact_shared_store.h \
+    contact_snapshot.h \
+    contact_storage.h \
+    contact_store.h \
+    contact_tests.h \
+    contact_writer.h \
+    field_scan.h \
+    fuzzy_index.h \
+    mapped_file.h \
+    phone_index.h \
+    string_pool.h
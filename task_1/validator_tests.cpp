@@ -0,0 +1,205 @@
+#include "Contact_class.h"
+#include "contact_tests.h"
+
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Differential tests: the hand-written validators must accept exactly what
+// the std::regex patterns they replaced accepted, on edge cases and on strings
+// generated from fragments that come close to valid input.
+
+namespace
+{
+    // The former implementations, kept verbatim as the reference.
+    std::string trim(const std::string& str)
+    {
+        const char* ws = " \t\n\r\f\v";
+
+        std::size_t first = str.find_first_not_of(ws);
+        if (first == std::string::npos)
+            return {};
+
+        std::size_t last = str.find_last_not_of(ws);
+        return str.substr(first, last - first + 1);
+    }
+
+    bool regexPersonalName(const std::string& personal_name)
+    {
+        static const std::regex re(R"(^[[:alpha:]](?:[[:alnum:] -]*[[:alnum:]])?$)");
+        return std::regex_match(personal_name, re);
+    }
+
+    bool regexEmail(const std::string& email)
+    {
+        static const std::regex re(
+            R"(^[A-Za-z0-9]+(\.[A-Za-z0-9]+)*@[A-Za-z0-9]+(\.[A-Za-z0-9]+)+$)"
+            );
+        return std::regex_match(email, re);
+    }
+
+    bool regexPhoneNumber(const std::string& raw_number)
+    {
+        std::string s = trim(raw_number);
+        if (s.empty())
+            return false;
+
+        static const std::regex re(
+            R"(^(?:\+7|8)(?:\d{10}|\(\d{3}\)\d{7}|\(\d{3}\)\d{3}-\d{2}-\d{2})$)"
+            );
+        return std::regex_match(s, re);
+    }
+
+    bool newPersonalName(const std::string& s) { return Contact::isValidPersonalName(s); }
+    bool newEmail       (const std::string& s) { return Contact::isValidEmail(s); }
+    bool newPhoneNumber (const std::string& s)
+    {
+        return Contact::isValidPhones({ Contact::Phone{ Contact::PhoneType::Work, s } });
+    }
+
+    using tests::Random;
+
+    std::string generate(Random& random, const std::vector<std::string>& fragments, std::size_t maxParts)
+    {
+        std::string s;
+        std::size_t parts = random.below(maxParts + 1);
+        for (std::size_t i = 0; i < parts; ++i)
+            s += fragments[random.below(fragments.size())];
+        return s;
+    }
+
+    using Validator = bool (*)(const std::string&);
+
+    // Compares both validators on every input; returns the number of disagreements
+    // and reports the first few.
+    std::size_t compare(const std::vector<std::string>& inputs, Validator reference, Validator candidate)
+    {
+        std::size_t mismatches = 0;
+        for (const std::string& s : inputs)
+        {
+            bool expected = reference(s);
+            if (candidate(s) == expected)
+                continue;
+
+            if (++mismatches <= 5)
+                tests::fail(__FILE__, __LINE__, "'" + s + "': regex says " + (expected ? "valid" : "invalid"));
+        }
+        return mismatches;
+    }
+
+    // Inserts, deletes or replaces up to two characters, taken from the fragments.
+    std::string mutate(Random& random, std::string s, const std::vector<std::string>& fragments)
+    {
+        std::size_t edits = random.below(3);
+        for (std::size_t i = 0; i < edits; ++i)
+        {
+            std::size_t pos = random.below(s.size() + 1);
+            const std::string& piece = fragments[random.below(fragments.size())];
+            switch (random.below(3))
+            {
+            case 0:
+                s.insert(pos, piece);
+                break;
+            case 1:
+                if (pos < s.size())
+                    s.erase(pos, 1);
+                break;
+            default:
+                if (pos < s.size())
+                    s.replace(pos, 1, piece);
+                break;
+            }
+        }
+        return s;
+    }
+
+    // The edge cases, then half random concatenations of fragments and half
+    // small edits of the valid edge cases, which stay close to the boundary.
+    std::vector<std::string> generated(const std::vector<std::string>& edges, const std::vector<std::string>& fragments,
+                                       std::size_t maxParts, std::uint64_t seed, Validator reference)
+    {
+        std::vector<std::string> valid;
+        for (const std::string& s : edges)
+        {
+            if (reference(s))
+                valid.push_back(s);
+        }
+
+        std::vector<std::string> inputs = edges;
+        Random random(seed);
+        for (int i = 0; i < 100000; ++i)
+        {
+            if (i % 2 == 0 || valid.empty())
+                inputs.push_back(generate(random, fragments, maxParts));
+            else
+                inputs.push_back(mutate(random, valid[random.below(valid.size())], fragments));
+        }
+        return inputs;
+    }
+
+    std::size_t accepted(const std::vector<std::string>& inputs, Validator v)
+    {
+        std::size_t n = 0;
+        for (const std::string& s : inputs)
+            n += v(s);
+        return n;
+    }
+}
+
+TEST(personal_name_matches_regex)
+{
+    std::vector<std::string> edges = {
+        "", " ", "-", "A", "z", "9", "A9", "9A", "Ab", "A b", "A-b", "A -", "A- ", "A--b", "A  b",
+        "Anna-Maria", "O Neil", "Ivan2", "Ivan ", " Ivan", "\tIvan", "Iv\tan", "Iv.an", "Iv_an",
+        "\xC3\x89lise", "Ren\xC3\xA9", "A\xC3\xA9" "b", std::string("A\0b", 3), "Jean-", "-Jean",
+    };
+    std::vector<std::string> fragments = { "A", "b", "z", "Z", "0", "9", " ", "-", "Ivan", "\t", ".", "_", "'", "\xC3\xA9", "\x80" };
+
+    std::vector<std::string> inputs = generated(edges, fragments, 6, 7, regexPersonalName);
+    CHECK_EQ(compare(inputs, regexPersonalName, newPersonalName), 0u);
+    CHECK(accepted(inputs, regexPersonalName) > 10000);
+}
+
+TEST(email_matches_regex)
+{
+    std::vector<std::string> edges = {
+        "", "@", "a@b", "a@b.c", "a.b@c.d", "a..b@c.d", ".a@b.c", "a.@b.c", "a@.b.c", "a@b.c.", "a@b..c",
+        "a@@b.c", "a@b.c@d.e", "A9@Z0.x9", "a b@c.d", "a@b.c ", " a@b.c", "a-b@c.d", "a_b@c.d", "a+b@c.d",
+        "ivan.petrov@mail.ru", "ivan@mail", "\xC3\xA9@b.c", "a@b.\xC3\xA9", "a@b.c\n",
+    };
+    std::vector<std::string> fragments = { "a", "Z", "0", "ab", "mail", ".", ".", "@", "@", "ru", " ", "-", "_", "+", "\xC3\xA9" };
+
+    std::vector<std::string> inputs = generated(edges, fragments, 8, 11, regexEmail);
+    CHECK_EQ(compare(inputs, regexEmail, newEmail), 0u);
+    CHECK(accepted(inputs, regexEmail) > 10000);
+}
+
+TEST(phone_number_matches_regex)
+{
+    std::vector<std::string> edges = {
+        "", " ", "8", "+7", "89991234567", "+79991234567", "79991234567", "8999123456", "899912345678",
+        "8(999)1234567", "+7(999)1234567", "8(999)123-45-67", "+7(999)123-45-67", "8(999)12-345-67",
+        "8(999)123-4567", "8 999 123 45 67", "8(99)91234567", "8(9991234567", "8999)1234567",
+        " 89991234567 ", "\t+7(999)123-45-67\n", "+8(999)1234567", "++79991234567", "8(999)123-45-6a",
+        "\xD9\xA1\xD9\xA2", "8999123456\xD9\xA1",
+    };
+    std::vector<std::string> fragments = { "+7", "8", "7", "(", ")", "-", "999", "123", "45", "67", "0", "1234567",
+                                           "9991234567", " ", "\t", "a" };
+
+    std::vector<std::string> inputs = generated(edges, fragments, 7, 13, regexPhoneNumber);
+    CHECK_EQ(compare(inputs, regexPhoneNumber, newPhoneNumber), 0u);
+    CHECK(accepted(inputs, regexPhoneNumber) > 10000);
+}
+
+TEST(packed_phone_prints_the_number_back)
+{
+    for (const char* number : { "89991234567", "+79991234567", "8(999)1234567", "+7(999)1234567",
+                                "8(000)000-00-00", "+7(999)123-45-67", "  89991234567\t" })
+    {
+        Contact::PackedPhone phone;
+        CHECK(Contact::PackedPhone::pack(Contact::PhoneType::Home, number, phone));
+        CHECK_EQ(phone.number(), trim(number));
+        CHECK(phone.type() == Contact::PhoneType::Home);
+    }
+}